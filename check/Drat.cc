@@ -0,0 +1,536 @@
+#include <pthread.h>
+
+#include "check/Drat.h"
+
+using namespace CDCL;
+
+
+DratChecker::DratChecker() :
+        nvars(0), nb_originals(0), failed(-1), nb_hashed(0), verbosity(0), error(NULL),
+        nb_lemmas(0), nb_core(0), nb_deletions(0), nb_ignored(0), nb_missing(0), nb_rounds(0) {
+    table.growTo(1024, -1);
+}
+
+
+//=================================================================================================
+// Reading the formula and the proof:
+
+
+uint32_t DratChecker::hash(const Lit *ps, int n) const {
+    uint32_t sum = 0, xored = 0;
+    for(int i = 0; i < n; i++) {
+        uint32_t h = hashLit(ps[i]);
+        sum += h;
+        xored ^= h * 0x85EBCA6Bu;
+    }
+    return sum ^ (xored << 7 | xored >> 25);
+}
+
+
+void DratChecker::hashClause(int c) {
+    if(nb_hashed >= table.size()) rehash();
+    uint32_t h = hash(&lits[start[c]], size[c]);
+    int b = (int) (h & (table.size() - 1));
+    hashes[c] = h;
+    next[c] = table[b];
+    table[b] = c;
+    nb_hashed++;
+}
+
+
+void DratChecker::rehash() {
+    vec<int> hashed;
+    for(int b = 0; b < table.size(); b++)
+        for(int c = table[b]; c != -1; c = next[c]) hashed.push(c);
+    int sz = table.size() * 2;
+    table.clear();
+    table.growTo(sz, -1);
+    for(int i = 0; i < hashed.size(); i++) {
+        int c = hashed[i], b = (int) (hashes[c] & (sz - 1));
+        next[c] = table[b];
+        table[b] = c;
+    }
+}
+
+
+// Remove from the table a clause with the same literals (in any order). Returns -1 if there is none:
+int DratChecker::unhashClause(vec<Lit> &ps) {
+    uint32_t h = hash(ps, ps.size());
+    for(int i = 0; i < ps.size(); i++) seen[toInt(ps[i])] = 1;
+    int *prev = &table[h & (table.size() - 1)], c;
+    for(c = *prev; c != -1; prev = &next[c], c = *prev) {
+        if(hashes[c] != h || size[c] != ps.size()) continue;
+        int i;
+        for(i = 0; i < ps.size() && seen[toInt(lits[start[c] + i])]; i++);
+        if(i == ps.size()) {
+            *prev = next[c];
+            nb_hashed--;
+            break;
+        }
+    }
+    for(int i = 0; i < ps.size(); i++) seen[toInt(ps[i])] = 0;
+    return c;
+}
+
+
+// Remove the duplicate literals, keeping the order of the others (the first one is the RAT pivot):
+void DratChecker::removeDuplicates(vec<Lit> &ps) {
+    int i, j;
+    for(i = 0; i < ps.size(); i++)
+        while(var(ps[i]) >= nvars) newVar();
+    for(i = j = 0; i < ps.size(); i++)
+        if(!seen[toInt(ps[i])]) seen[toInt(ps[i])] = 1, ps[j++] = ps[i];
+    ps.shrink(i - j);
+    for(i = 0; i < ps.size(); i++) seen[toInt(ps[i])] = 0;
+}
+
+
+int DratChecker::newClause(const vec<Lit> &ps) {
+    int c = start.size();
+    start.push(lits.size());
+    size.push(ps.size());
+    for(int i = 0; i < ps.size(); i++) lits.push(ps[i]);
+    if(ps.size() <= 1) units.push(c);
+    marks.push(0);
+    verified.push(0);
+    next.push(-1);
+    hashes.push(0);
+    return c;
+}
+
+
+bool DratChecker::addClause_(vec<Lit> &ps) {
+    assert(events.size() == 0);
+    removeDuplicates(ps);
+    hashClause(newClause(ps));
+    nb_originals++;
+    return true;
+}
+
+
+/**
+ * Read the proof, matching each deletion with a clause. The steps after the first empty clause
+ * are ignored.
+ */
+
+void DratChecker::readProof(ProofReader &in) {
+    bool deletion;
+    vec<Lit> ps;
+    while(in.readDrat(deletion, ps)) {
+        removeDuplicates(ps);
+        if(deletion) {
+            if(ps.size() <= 1) {     // Unit deletions are ignored (as most checkers do)
+                nb_ignored++;
+                continue;
+            }
+            int c = unhashClause(ps);
+            if(c == -1) {
+                nb_missing++;
+                continue;
+            }
+            events.push(2 * c + 1);
+            nb_deletions++;
+        } else {
+            int c = newClause(ps);
+            hashClause(c);
+            events.push(2 * c);
+            nb_lemmas++;
+            if(ps.size() == 0) break;
+        }
+    }
+}
+
+
+//=================================================================================================
+// Checking:
+
+
+static void *runEngine(void *engine) {
+    ((DratEngine *) engine)->run();
+    return NULL;
+}
+
+
+/**
+ * Check the proof.
+ * @param threads the number of engines walking the proof concurrently
+ * @return true if the proof is verified, false otherwise ('error' gives the reason).
+ */
+
+bool DratChecker::check(int threads) {
+    // Forward pass, up to the first conflict:
+    DratEngine *main = new DratEngine(*this, 0, 0);
+    main->addOriginals();
+    vec<int> kept;
+    for(int t = 0; t < events.size() && main->top_conflict == -1; t++) {
+        int c = events[t] >> 1;
+        if(events[t] & 1) {
+            if(main->isReason(c)) {
+                nb_ignored++;
+                continue;
+            }
+            main->deactivate(c);
+        } else {
+            if(size[c] == 0) break;
+            main->activate(c);
+        }
+        kept.push(events[t]);
+    }
+    if(main->top_conflict == -1) {
+        error = "no conflict";
+        delete main;
+        return false;
+    }
+    kept.moveTo(events);
+    main->time = events.size();
+    main->conflict();
+
+    // Backward passes:
+    if(threads < 1) threads = 1;
+    if(threads > events.size() / 64 + 1) threads = events.size() / 64 + 1;
+    vec<DratEngine *> engines;
+    for(int k = 0; k < threads - 1; k++)
+        engines.push(new DratEngine(*this, (int) ((int64_t) events.size() * k / threads),
+                                    (int) ((int64_t) events.size() * (k + 1) / threads)));
+    main->setChunk(engines.size() == 0 ? 0 : engines.last()->hi, events.size());
+    engines.push(main);
+
+    vec<pthread_t> tids(engines.size());
+    vec<char> pending(engines.size(), 1);
+    for(bool again = true; again && failed == -1;) {
+        nb_rounds++;
+        if(engines.size() == 1)
+            main->run();
+        else {
+            for(int k = 0; k < engines.size(); k++)
+                if(pending[k]) pthread_create(&tids[k], NULL, runEngine, engines[k]);
+            for(int k = 0; k < engines.size(); k++)
+                if(pending[k]) pthread_join(tids[k], NULL);
+        }
+
+        again = false;
+        for(int k = 0; k < engines.size(); k++) {
+            pending[k] = 0;
+            for(int t = engines[k]->lo; t < engines[k]->hi && !pending[k]; t++) {
+                int c = events[t] >> 1;
+                if(!(events[t] & 1) && marked(c) && !verified[c]) pending[k] = 1;
+            }
+            if(pending[k]) again = true;
+        }
+        if(verbosity > 0)
+            printf("c Round %" PRIi64 " done, %s\n", nb_rounds, again ? "some lemmas left" : "all lemmas checked");
+    }
+
+    for(int k = 0; k < engines.size(); k++) delete engines[k];
+    for(int t = 0; t < events.size(); t++)
+        if(!(events[t] & 1) && marked(events[t] >> 1)) nb_core++;
+
+    if(failed != -1) {
+        error = "a lemma can not be derived";
+        if(verbosity > 0) {
+            printf("c Failed lemma:");
+            for(int i = start[failed]; i < start[failed] + size[failed]; i++)
+                printf(" %s%d", sign(lits[i]) ? "-" : "", var(lits[i]) + 1);
+            printf(" 0\n");
+        }
+        return false;
+    }
+    return true;
+}
+
+
+//=================================================================================================
+// Engine:
+
+
+DratEngine::DratEngine(DratChecker &d, int l, int h) :
+        D(d), head_core(0), head_all(0), top(0), lo(l), hi(h), time(-1), top_conflict(-1) {
+    D.lits.copyTo(lits);
+    active.growTo(D.start.size(), 0);
+    watches_core.growTo(2 * D.nvars);
+    watches.growTo(2 * D.nvars);
+    assigns.growTo(D.nvars, l_Undef);
+    reason.growTo(D.nvars, -1);
+    seen.growTo(D.nvars, 0);
+}
+
+
+bool DratEngine::isReason(int c) const {
+    if(D.size[c] == 0) return false;
+    Lit p = lits[D.start[c]];
+    return value(p) == l_True && reason[var(p)] == c;
+}
+
+
+// Undo the assignments above the top level:
+void DratEngine::cancel() {
+    for(int i = trail.size() - 1; i >= top; i--) {
+        assigns[var(trail[i])] = l_Undef;
+        reason[var(trail[i])] = -1;
+    }
+    trail.shrink(trail.size() - top);
+    head_core = head_all = top;
+}
+
+
+// Propagate the formula at the top level from scratch:
+void DratEngine::reset() {
+    top = 0;
+    cancel();
+    top_conflict = -1;
+    for(int i = 0; i < D.units.size() && top_conflict == -1; i++) {
+        int c = D.units[i];
+        if(!active[c]) continue;
+        if(D.size[c] == 0 || value(lits[D.start[c]]) == l_False) top_conflict = c;
+        else if(value(lits[D.start[c]]) == l_Undef) assign(lits[D.start[c]], c);
+    }
+    if(top_conflict == -1) top_conflict = propagate();
+    top = trail.size();
+}
+
+
+void DratEngine::detach(int c, Lit p) {
+    for(int pass = 0; pass < 2; pass++) {
+        vec<int> &ws = pass == 0 ? watches_core[toInt(p)] : watches[toInt(p)];
+        for(int i = 0; i < ws.size(); i++)
+            if(ws[i] == c) {
+                ws[i] = ws.last();
+                ws.pop();
+                return;
+            }
+    }
+}
+
+
+/**
+ * Add a clause to the formula, and propagate it at the top level. The literals which are not false
+ * are moved to the front to be watched.
+ */
+
+void DratEngine::activate(int c) {
+    active[c] = 1;
+    int n = D.size[c];
+    Lit *cl = &lits[D.start[c]];
+    int k = 0;
+    if(top_conflict == -1)
+        for(int i = 0; i < n && k < 2; i++)
+            if(value(cl[i]) != l_False) {
+                Lit tmp = cl[k];
+                cl[k++] = cl[i], cl[i] = tmp;
+            }
+    if(n >= 2) {
+        bool core = D.marked(c);
+        (core ? watches_core : watches)[toInt(cl[0])].push(c);
+        (core ? watches_core : watches)[toInt(cl[1])].push(c);
+    }
+    if(top_conflict != -1) return;    // (the formula will be propagated again when the conflict goes)
+
+    if(k == 0) top_conflict = c;
+    else if(k == 1 && value(cl[0]) == l_Undef) {
+        assign(cl[0], c);
+        top_conflict = propagate();
+        top = trail.size();
+    }
+}
+
+
+void DratEngine::deactivate(int c) {
+    active[c] = 0;
+    if(D.size[c] >= 2) {
+        detach(c, lits[D.start[c]]);
+        detach(c, lits[D.start[c] + 1]);
+    }
+    if(top_conflict != -1 || isReason(c)) reset();
+}
+
+
+void DratEngine::addOriginals() {
+    for(int c = 0; c < D.nb_originals; c++) activate(c);
+    time = 0;
+}
+
+
+/**
+ * Propagate the assignment of 'false_lit' to false through a watch list.
+ * @param core true if 'ws' is a list of core clauses. Otherwise, the clauses that have been marked
+ * since they were attached are moved to the core lists.
+ * @return the conflicting clause, or -1
+ */
+
+int DratEngine::propagateList(vec<int> &ws, Lit false_lit, bool core) {
+    int i, j, n = ws.size(), confl = -1;
+    for(i = j = 0; i < n; i++) {
+        int c = ws[i];
+        Lit *cl = &lits[D.start[c]];
+        if(cl[0] == false_lit) cl[0] = cl[1], cl[1] = false_lit;
+        assert(cl[1] == false_lit);
+        bool to_core = !core && D.marked(c);
+
+        bool moved = false;
+        if(value(cl[0]) != l_True)
+            for(int k = 2, sz = D.size[c]; k < sz; k++)
+                if(value(cl[k]) != l_False) {
+                    cl[1] = cl[k], cl[k] = false_lit;
+                    (core || to_core ? watches_core : watches)[toInt(cl[1])].push(c);
+                    moved = true;
+                    break;
+                }
+        if(moved) continue;
+
+        if(to_core) watches_core[toInt(false_lit)].push(c);
+        else ws[j++] = c;
+        if(value(cl[0]) == l_False) {
+            confl = c;
+            for(i++; i < n; i++) ws[j++] = ws[i];
+            break;
+        }
+        if(value(cl[0]) == l_Undef) assign(cl[0], c);
+    }
+    ws.shrink(i - j);
+    return confl;
+}
+
+
+// Propagate the trail, the core clauses first. Returns the conflicting clause, or -1:
+int DratEngine::propagate() {
+    for(;;) {
+        while(head_core < trail.size()) {
+            Lit p = trail[head_core++];
+            int confl = propagateList(watches_core[toInt(~p)], ~p, true);
+            if(confl != -1) return confl;
+        }
+        if(head_all == trail.size()) return -1;
+        Lit p = trail[head_all++];
+        int confl = propagateList(watches[toInt(~p)], ~p, false);
+        if(confl != -1) return confl;
+    }
+}
+
+
+/**
+ * Mark the clauses involved in a conflict: the conflicting clause and the reasons of the literals
+ * it depends on, at all levels.
+ * @param confl the conflicting clause, or -1 to start from the literal 'seed' instead
+ */
+
+void DratEngine::analyze(int confl, Lit seed) {
+    int pending = 0;
+    if(confl != -1) {
+        D.mark(confl);
+        for(int i = D.start[confl]; i < D.start[confl] + D.size[confl]; i++)
+            if(!seen[var(lits[i])]) seen[var(lits[i])] = 1, pending++;
+    } else
+        seen[var(seed)] = 1, pending++;
+
+    for(int i = trail.size() - 1; pending > 0; i--) {
+        Var v = var(trail[i]);
+        if(!seen[v]) continue;
+        seen[v] = 0;
+        pending--;
+        int r = reason[v];
+        if(r == -1) continue;
+        D.mark(r);
+        for(int k = D.start[r] + 1; k < D.start[r] + D.size[r]; k++)
+            if(!seen[var(lits[k])]) seen[var(lits[k])] = 1, pending++;
+    }
+}
+
+
+// Reverse unit propagation: does the negation of the clause propagate to a conflict?
+bool DratEngine::rup(const Lit *ps, int n) {
+    for(int i = 0; i < n; i++)
+        if(value(ps[i]) == l_True) {    // Already implied at the top level
+            analyze(-1, ps[i]);
+            return true;
+        }
+    for(int i = 0; i < n; i++) {
+        if(value(ps[i]) == l_True) {    // A tautology
+            cancel();
+            return true;
+        }
+        if(value(ps[i]) == l_Undef) assign(~ps[i], -1);
+    }
+    int confl = propagate();
+    if(confl != -1) analyze(confl);
+    cancel();
+    return confl != -1;
+}
+
+
+// Resolution asymmetric tautology on the first literal of the lemma:
+bool DratEngine::rat(int c) {
+    if(D.size[c] == 0) return false;
+    const Lit *ps = &D.lits[D.start[c]];
+    Lit pivot = ~ps[0];
+    vec<int> candidates;
+    for(int d = 0; d < active.size(); d++) {
+        if(!active[d]) continue;
+        for(int i = D.start[d]; i < D.start[d] + D.size[d]; i++)
+            if(lits[i] == pivot) {
+                candidates.push(d);
+                break;
+            }
+    }
+    for(int k = 0; k < candidates.size(); k++) {
+        int d = candidates[k];
+        resolvent.clear();
+        for(int i = 0; i < D.size[c]; i++) resolvent.push(ps[i]);
+        for(int i = D.start[d]; i < D.start[d] + D.size[d]; i++)
+            if(lits[i] != pivot) resolvent.push(lits[i]);
+        if(!rup(resolvent, resolvent.size())) return false;
+    }
+    for(int k = 0; k < candidates.size(); k++) D.mark(candidates[k]);
+    return true;
+}
+
+
+// Mark the clauses involved in the top-level conflict:
+void DratEngine::conflict() {
+    assert(top_conflict != -1);
+    analyze(top_conflict);
+}
+
+
+// Replay the proof steps in [from, to):
+void DratEngine::forward(int from, int to) {
+    for(int t = from; t < to; t++) {
+        int c = D.events[t] >> 1;
+        if(D.events[t] & 1) deactivate(c);
+        else activate(c);
+    }
+    time = to;
+}
+
+
+// Walk the steps of the chunk backwards, checking the marked lemmas:
+void DratEngine::backward() {
+    assert(time == hi);
+    for(int t = hi - 1; t >= lo; t--) {
+        if(__atomic_load_n(&D.failed, __ATOMIC_RELAXED) != -1) break;
+        int c = D.events[t] >> 1;
+        if(D.events[t] & 1) {
+            activate(c);
+            continue;
+        }
+        deactivate(c);
+        if(!D.marked(c) || D.verified[c]) continue;
+        bool ok;
+        if(top_conflict != -1)
+            ok = true, analyze(top_conflict);
+        else
+            ok = rup(&D.lits[D.start[c]], D.size[c]) || rat(c);
+        if(ok) D.verified[c] = 1;
+        else __atomic_store_n(&D.failed, c, __ATOMIC_RELAXED);
+    }
+    time = lo;
+}
+
+
+void DratEngine::run() {
+    if(time == -1) {
+        addOriginals();
+        forward(0, hi);
+    } else if(time == lo)
+        forward(lo, hi);
+    backward();
+}
@@ -0,0 +1,136 @@
+#ifndef Minisat_Drat_h
+#define Minisat_Drat_h
+
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+#include "check/ProofReader.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// DratChecker -- checks a DRAT proof backwards:
+//
+// A forward pass propagates the formula at the top level as the proof is replayed, until the first
+// conflict. The clauses involved in that conflict are marked, and the proof is then walked
+// backwards: each marked lemma is removed from the formula and checked by reverse unit propagation
+// (falling back to a RAT check on its first literal), which marks the clauses it depends on.
+// Unmarked lemmas are never checked.
+//
+// Propagation visits marked ("core") clauses first, as they are the ones that conflicts should be
+// built from. Deleting a clause that is the reason of a top-level literal is ignored.
+//
+// With several threads, the proof is split into chunks of consecutive steps, each one walked by
+// its own engine. Marks made in a chunk on lemmas of an earlier chunk which has already been
+// walked are picked up by another round, until no marked lemma is left unchecked.
+
+    class DratEngine;
+
+    class DratChecker {
+        friend class DratEngine;
+
+        int nvars;
+        vec<Lit> lits;               // The literals of all clauses (in input order), indexed by 'start'.
+        vec<int> start, size;
+        int nb_originals;
+        vec<int> events;             // The proof steps: 2 * clause + (1 if deletion).
+        vec<int> units;              // The unit clauses.
+
+        vec<char> marks;             // Shared between the engines, only accessed atomically.
+        vec<char> verified;          // Written by the engine owning the step of a lemma.
+        volatile int failed;         // The lemma whose check failed, or -1.
+
+        // Clauses which may still be deleted, hashed on their literals:
+        vec<int> table, next;
+        vec<uint32_t> hashes;
+        int nb_hashed;
+        vec<char> seen;
+
+        static uint32_t hashLit(Lit p) {
+            uint32_t x = (uint32_t) toInt(p) * 0x9E3779B1u;
+            return x ^ (x >> 15);
+        }
+        uint32_t hash(const Lit *ps, int n) const;
+        void removeDuplicates(vec<Lit> &ps);
+        void hashClause(int c);
+        int unhashClause(vec<Lit> &ps);
+        void rehash();
+
+        int newClause(const vec<Lit> &ps);
+
+        bool marked(int c) const { return __atomic_load_n(&marks[c], __ATOMIC_RELAXED) != 0; }
+        void mark(int c) { __atomic_store_n(&marks[c], 1, __ATOMIC_RELAXED); }
+
+    public:
+        DratChecker();
+
+        int verbosity;
+        const char *error;           // Why the check failed.
+        int64_t nb_lemmas, nb_core, nb_deletions, nb_ignored, nb_missing, nb_rounds;
+
+        // Interface of the DIMACS parser:
+        int nVars() const { return nvars; }
+        Var newVar() { seen.push(0), seen.push(0); return nvars++; }
+        bool addClause_(vec<Lit> &ps);
+
+        void readProof(ProofReader &in);
+        bool check(int threads);      // TRUE if the proof refutes the formula.
+    };
+
+
+//=================================================================================================
+// DratEngine -- unit propagation over the formula at some step of the proof (see 'Drat.cc').
+
+
+    class DratEngine {
+        DratChecker &D;
+
+        vec<Lit> lits;               // Own copy: the watched literals are moved to the front.
+        vec<char> active;
+        vec<vec<int> > watches_core; // Indexed by literal: the clauses watching it.
+        vec<vec<int> > watches;
+        vec<lbool> assigns;
+        vec<int> reason;
+        vec<Lit> trail;
+        int head_core, head_all;
+        int top;                     // Size of the top-level part of the trail.
+        vec<char> seen;
+        vec<Lit> resolvent;
+
+        lbool value(Lit p) const { return assigns[var(p)] ^ sign(p); }
+        void assign(Lit p, int from) {
+            assigns[var(p)] = lbool(!sign(p));
+            reason[var(p)] = from;
+            trail.push(p);
+        }
+        void cancel();
+        void reset();
+        void detach(int c, Lit p);
+        int propagateList(vec<int> &ws, Lit false_lit, bool core);
+        int propagate();
+        void analyze(int confl, Lit seed = lit_Undef);
+        bool rup(const Lit *ps, int n);
+        bool rat(int c);
+
+    public:
+        DratEngine(DratChecker &d, int l, int h);
+
+        int lo, hi;                  // The steps walked by this engine.
+        int time;                    // The formula is the one before this step (-1 if not built yet).
+        int top_conflict;            // A clause falsified at the top level, or -1.
+
+        void setChunk(int l, int h) { lo = l, hi = h; }
+
+        bool isReason(int c) const;
+        void activate(int c);
+        void deactivate(int c);
+        void addOriginals();
+        void conflict();
+        void forward(int from, int to);
+        void backward();
+        void run();
+    };
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "check/Lrat.h"
+
+using namespace CDCL;
+
+
+LratChecker::LratChecker() :
+        nvars(0), nb_originals(0), live(0), wasted(0), now(0), verbosity(0), error(NULL),
+        nb_lemmas(0), nb_deletions(0), nb_hints(0) {}
+
+
+bool LratChecker::store(int64_t id, const vec<Lit> &ps) {
+    if(id <= 0 || id >= INT32_MAX) {
+        error = "clause identifier out of range";
+        return false;
+    }
+    int c = (int) id;
+    if(c >= start.size()) {
+        start.growTo(c + 1, -1);
+        size.growTo(c + 1, 0);
+    }
+    if(start[c] != -1) {
+        error = "clause identifier used twice";
+        return false;
+    }
+    if(wasted > live && wasted > 1024 * 1024) compact();
+
+    start[c] = lits.size();
+    size[c] = ps.size();
+    for(int i = 0; i < ps.size(); i++) lits.push(ps[i]);
+    live += ps.size();
+    return true;
+}
+
+
+// Remove the literals of deleted clauses from 'lits':
+void LratChecker::compact() {
+    vec<Lit> to;
+    to.capacity((int) live);
+    for(int id = 0; id < start.size(); id++)
+        if(start[id] != -1) {
+            int s = start[id];
+            start[id] = to.size();
+            for(int i = 0; i < size[id]; i++) to.push(lits[s + i]);
+        }
+    to.moveTo(lits);
+    wasted = 0;
+}
+
+
+/**
+ * Check that the negation of a clause, followed by the propagation of its hints, leads to a conflict.
+ * @param ps the clause
+ * @param hints the identifiers of the clauses to propagate, in order
+ * @return false (with 'error' set) if the check fails
+ */
+
+bool LratChecker::checkStep(const vec<Lit> &ps, const vec<int64_t> &hints) {
+    if(++now == 0) {      // Stamps wrapped around
+        for(int i = 0; i < stamp.size(); i++) stamp[i] = 0;
+        now = 1;
+    }
+    for(int i = 0; i < ps.size(); i++) {
+        if(var(ps[i]) >= nvars) return true;           // A fresh variable: the check below can not use it
+        if(stamp[toInt(ps[i])] == now) return true;   // A tautology
+        stamp[toInt(~ps[i])] = now;
+    }
+
+    for(int h = 0; h < hints.size(); h++) {
+        nb_hints++;
+        if(hints[h] < 0) {
+            error = "RAT hints are not supported";
+            return false;
+        }
+        if(hints[h] >= start.size() || start[(int) hints[h]] == -1) {
+            error = "hint refers to a missing clause";
+            return false;
+        }
+
+        int c = (int) hints[h];
+        Lit unit = lit_Undef;
+        for(int i = start[c], end = start[c] + size[c]; i < end; i++) {
+            Lit p = lits[i];
+            if(var(p) >= nvars) {
+                unit = unit == lit_Undef ? p : lit_Error;
+                continue;
+            }
+            if(stamp[toInt(p)] == now) {
+                error = "hint clause is satisfied";
+                return false;
+            }
+            if(stamp[toInt(~p)] != now)
+                unit = unit == lit_Undef ? p : lit_Error;
+        }
+        if(unit == lit_Undef) return true;                // Conflict
+        if(unit == lit_Error) {
+            error = "hint clause is not unit";
+            return false;
+        }
+        if(var(unit) >= nvars) {
+            error = "hint clause is unit on an unknown variable";
+            return false;
+        }
+        stamp[toInt(unit)] = now;
+    }
+    error = "hints do not lead to a conflict";
+    return false;
+}
+
+
+/**
+ * Check the whole proof.
+ * @return true if the empty clause is derived, false otherwise ('error' gives the reason).
+ */
+
+bool LratChecker::check(ProofReader &in) {
+    bool deletion;
+    int64_t id;
+    vec<Lit> ps;
+    vec<int64_t> hints;
+
+    while(in.readLrat(deletion, id, ps, hints)) {
+        if(deletion) {
+            for(int i = 0; i < hints.size(); i++) {
+                if(hints[i] <= 0 || hints[i] >= start.size()) continue;
+                int d = (int) hints[i];
+                if(start[d] == -1) continue;    // (deleting a missing clause is harmless)
+                start[d] = -1;
+                live -= size[d];
+                wasted += size[d];
+                nb_deletions++;
+            }
+            continue;
+        }
+
+        nb_lemmas++;
+        if(!checkStep(ps, hints) || !store(id, ps)) {
+            if(verbosity > 0) fprintf(stderr, "c Failed on lemma %" PRIi64 ".\n", id);
+            return false;
+        }
+        if(ps.size() == 0) return true;
+    }
+    error = "no empty clause";
+    return false;
+}
@@ -0,0 +1,49 @@
+#ifndef Minisat_Lrat_h
+#define Minisat_Lrat_h
+
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+#include "check/ProofReader.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// LratChecker -- checks an LRAT proof in a single linear pass:
+//
+// Each added clause is checked by assigning its negation and walking through its hints, which must
+// all be unit (the literal is then assigned) except the last one, which must be falsified. Only
+// RUP steps are supported (the solver never logs RAT steps).
+
+
+    class LratChecker {
+        int nvars;
+        vec<Lit> lits;               // The literals of all clauses, indexed by 'start'.
+        vec<int> start, size;        // For each identifier: where the clause is in 'lits' (-1 if none) and its size.
+        int64_t nb_originals;
+        uint64_t live, wasted;       // Literals in use / of deleted clauses in 'lits'.
+        vec<uint32_t> stamp;         // A literal is true in the current check if its stamp is 'now'.
+        uint32_t now;
+
+        bool store(int64_t id, const vec<Lit> &ps);
+        void compact();
+        bool checkStep(const vec<Lit> &ps, const vec<int64_t> &hints);
+
+    public:
+        LratChecker();
+
+        int verbosity;
+        const char *error;           // Why the check failed.
+        int64_t nb_lemmas, nb_deletions, nb_hints;
+
+        // Interface of the DIMACS parser (original clauses are numbered in input order):
+        int nVars() const { return nvars; }
+        Var newVar() { stamp.push(0), stamp.push(0); return nvars++; }
+        bool addClause_(vec<Lit> &ps) { return store(++nb_originals, ps); }
+
+        bool check(ProofReader &in);  // TRUE if the proof derives the empty clause.
+    };
+
+//=================================================================================================
+}
+
+#endif
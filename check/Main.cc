@@ -0,0 +1,85 @@
+#include <zlib.h>
+
+#include "utils/System.h"
+#include "utils/ParseUtils.h"
+#include "utils/Options.h"
+#include "core/Dimacs.h"
+#include "check/ProofReader.h"
+#include "check/Drat.h"
+#include "check/Lrat.h"
+
+using namespace CDCL;
+
+//=================================================================================================
+// Main:
+
+
+int main(int argc, char **argv) {
+    try {
+        setUsageHelp("USAGE: %s [options] <input-file> <proof-file>\n\n  where input may be either in plain or gzipped DIMACS,\n"
+                     "  and the proof in DRAT or LRAT, text or binary (detected).\n");
+
+        IntOption verb("MAIN", "verb", "Verbosity level (0=silent, 1=some).", 1, IntRange(0, 1));
+        IntOption threads("MAIN", "threads", "Number of threads checking a DRAT proof.", 1, IntRange(1, 256));
+        BoolOption lrat("MAIN", "lrat", "The proof is in LRAT (checked in a single linear pass) instead of DRAT.", false);
+
+        parseOptions(argc, argv, true);
+        if(argc != 3) {
+            printf("c ERROR! Expected a formula and a proof. Use '--help' for help.\n");
+            exit(1);
+        }
+
+        double initial_time = cpuTime();
+        gzFile in = gzopen(argv[1], "rb");
+        if(in == NULL)
+            printf("c ERROR! Could not open file: %s\n", argv[1]), exit(1);
+        gzFile proof = gzopen(argv[2], "rb");
+        if(proof == NULL)
+            printf("c ERROR! Could not open file: %s\n", argv[2]), exit(1);
+        bool binary = ProofReader::isBinary(proof);
+        ProofReader reader(proof, binary);
+
+        bool verified;
+        const char *error;
+        if(lrat) {
+            LratChecker C;
+            C.verbosity = verb;
+            parse_DIMACS(in, C);
+            verified = C.check(reader);
+            error = C.error;
+            if(verb > 0) {
+                printf("c Lemmas:               %12" PRIi64 "\n", C.nb_lemmas);
+                printf("c Deletions:            %12" PRIi64 "\n", C.nb_deletions);
+                printf("c Hints:                %12" PRIi64 "\n", C.nb_hints);
+            }
+        } else {
+            DratChecker C;
+            C.verbosity = verb;
+            parse_DIMACS(in, C);
+            C.readProof(reader);
+            if(verb > 0)
+                printf("c Parse time:           %12.2f s\n", cpuTime() - initial_time);
+            verified = C.check(threads);
+            error = C.error;
+            if(verb > 0) {
+                printf("c Lemmas:               %12" PRIi64 "   (%" PRIi64 " in the core)\n", C.nb_lemmas, C.nb_core);
+                printf("c Deletions:            %12" PRIi64 "   (%" PRIi64 " ignored, %" PRIi64 " missing)\n",
+                       C.nb_deletions, C.nb_ignored, C.nb_missing);
+                printf("c Rounds:               %12" PRIi64 "\n", C.nb_rounds);
+            }
+        }
+        gzclose(in);
+        gzclose(proof);
+
+        if(verb > 0) {
+            if(!verified) printf("c Reason: %s\n", error);
+            printf("c CPU time:             %12.2f s\n", cpuTime() - initial_time);
+        }
+        printf(verified ? "s VERIFIED\n" : "s NOT VERIFIED\n");
+        exit(verified ? 0 : 1);
+    } catch(OutOfMemoryException &) {
+        printf("c \n\n");
+        printf("s NOT VERIFIED\n");
+        exit(1);
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef Minisat_ProofReader_h
+#define Minisat_ProofReader_h
+
+#include <zlib.h>
+
+#include "mtl/Vec.h"
+#include "utils/ParseUtils.h"
+#include "core/SolverTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// ProofReader -- reads DRAT or LRAT proofs, in text or binary form (see 'core/Proof.h'):
+
+
+    class ProofReader {
+        StreamBuffer in;
+        bool binary;
+
+
+        uint64_t readBinary() {
+            uint64_t x = 0;
+            int shift = 0;
+            for(;;) {
+                if(*in == EOF) fprintf(stderr, "PARSE ERROR! Unexpected end of binary proof.\n"), exit(3);
+                int b = *in;
+                ++in;
+                x |= (uint64_t) (b & 127) << shift;
+                if(b < 128) return x;
+                shift += 7;
+            }
+        }
+
+
+        int64_t readText() {
+            int64_t val = 0;
+            bool neg = false;
+            skipWhitespace(in);
+            if(*in == '-') neg = true, ++in;
+            if(*in < '0' || *in > '9') fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+            while(*in >= '0' && *in <= '9')
+                val = val * 10 + (*in - '0'), ++in;
+            return neg ? -val : val;
+        }
+
+
+        Lit readLit(int64_t x) { return x > 0 ? mkLit((Var) (x - 1)) : ~mkLit((Var) (-x - 1)); }
+
+
+        void readLits(vec<Lit> &lits) {
+            lits.clear();
+            for(;;) {
+                int64_t x;
+                if(binary) {
+                    uint64_t u = readBinary();
+                    x = u == 0 ? 0 : (u & 1 ? -(int64_t) (u >> 1) : (int64_t) (u >> 1));
+                } else
+                    x = readText();
+                if(x == 0) break;
+                lits.push(readLit(x));
+            }
+        }
+
+
+        void readIds(vec<int64_t> &ids) {
+            ids.clear();
+            for(;;) {
+                int64_t x;
+                if(binary) {
+                    uint64_t u = readBinary();
+                    x = u & 1 ? -(int64_t) (u >> 1) : (int64_t) (u >> 1);
+                } else
+                    x = readText();
+                if(x == 0) break;
+                ids.push(x);
+            }
+        }
+
+
+        // Skip comments and blank space. Returns FALSE at the end of the proof:
+        bool nextStep() {
+            for(;;) {
+                if(!binary) skipWhitespace(in);
+                if(*in == EOF) return false;
+                if(!binary && *in == 'c') skipLine(in);
+                else return true;
+            }
+        }
+
+
+    public:
+        ProofReader(gzFile f, bool bin) : in(f), binary(bin) {}
+
+
+        // A binary proof contains null bytes (the terminators), a text proof never does:
+        static bool isBinary(gzFile f) {
+            unsigned char buf[4096];
+            int n = gzread(f, buf, sizeof(buf));
+            gzrewind(f);
+            for(int i = 0 ; i < n ; i++)
+                if(buf[i] == 0) return true;
+            return false;
+        }
+
+
+        // DRAT: read the next step. Returns FALSE at the end of the proof.
+        bool readDrat(bool &deletion, vec<Lit> &lits) {
+            if(!nextStep()) return false;
+            if(binary) {
+                if(*in != 'a' && *in != 'd') fprintf(stderr, "PARSE ERROR! Unexpected byte in binary proof: %d\n", *in), exit(3);
+                deletion = *in == 'd';
+                ++in;
+            } else if((deletion = *in == 'd'))
+                ++in;
+            readLits(lits);
+            return true;
+        }
+
+
+        // LRAT: read the next step: an addition (with its identifier, literals and hints) or a deletion
+        // (with the identifiers in 'hints'). Returns FALSE at the end of the proof.
+        bool readLrat(bool &deletion, int64_t &id, vec<Lit> &lits, vec<int64_t> &hints) {
+            if(!nextStep()) return false;
+            if(binary) {
+                if(*in != 'a' && *in != 'd') fprintf(stderr, "PARSE ERROR! Unexpected byte in binary proof: %d\n", *in), exit(3);
+                deletion = *in == 'd';
+                ++in;
+                id = deletion ? 0 : (int64_t) (readBinary() >> 1);
+            } else {
+                id = readText();
+                skipWhitespace(in);
+                if((deletion = *in == 'd')) ++in;
+            }
+            lits.clear();
+            if(!deletion) readLits(lits);
+            readIds(hints);
+            return true;
+        }
+    };
+
+//=================================================================================================
+}
+
+#endif
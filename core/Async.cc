@@ -0,0 +1,166 @@
+#include "core/Async.h"
+
+using namespace CDCL;
+
+
+/**
+ * Start a search on the threads of an executor. The handle must be deleted by the caller, which
+ * first cancels the search if it is not over.
+ * @param executor
+ * @param assumps the assumptions of the search
+ * @return the handle of the search
+ */
+
+SolveHandle *Solver::solveAsync(SolveExecutor &executor, const vec<Lit> &assumps) {
+    SolveHandle *h = new SolveHandle(*this, executor);
+    beginSolve(assumps);
+    executor.submit(h);
+    return h;
+}
+
+
+//=================================================================================================
+// SolveHandle
+//=================================================================================================
+
+
+SolveHandle::SolveHandle(Solver &s, SolveExecutor &e) : S(s), executor(e), done(false), cancelled(false), result_(l_Undef) {
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&finished, NULL);
+}
+
+
+SolveHandle::~SolveHandle() {
+    cancel();
+    wait();
+    pthread_cond_destroy(&finished);
+    pthread_mutex_destroy(&lock);
+}
+
+
+/**
+ * Publish the result of a search that is over. The interrupt of a cancellation is cleared in the
+ * same critical section as 'done' is set, so that a 'cancel()' cannot interrupt the next search.
+ * @param r
+ */
+
+void SolveHandle::finish(lbool r) {
+    pthread_mutex_lock(&lock);
+    if(cancelled) S.clearInterrupt();
+    result_ = r;
+    done = true;
+    pthread_cond_broadcast(&finished);
+    pthread_mutex_unlock(&lock);
+}
+
+
+bool SolveHandle::ready() {
+    pthread_mutex_lock(&lock);
+    bool r = done;
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+
+lbool SolveHandle::wait() {
+    pthread_mutex_lock(&lock);
+    while(!done) pthread_cond_wait(&finished, &lock);
+    lbool r = result_;
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+
+lbool SolveHandle::result() {
+    pthread_mutex_lock(&lock);
+    lbool r = done ? result_ : l_Undef;
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+
+void SolveHandle::cancel() {
+    pthread_mutex_lock(&lock);
+    if(!done) {
+        cancelled = true;
+        S.interrupt();                  // (stops a step in progress)
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+
+//=================================================================================================
+// SolveExecutor
+//=================================================================================================
+
+
+SolveExecutor::SolveExecutor(int nb_threads, int64_t quantum_conflicts) : head(0), stopping(false), quantum(quantum_conflicts) {
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&work, NULL);
+    threads.growTo(nb_threads);
+    for(int i = 0; i < nb_threads; i++)
+        pthread_create(&threads[i], NULL, worker, this);
+}
+
+
+SolveExecutor::~SolveExecutor() {
+    pthread_mutex_lock(&lock);
+    for(int i = head; i < queue.size(); i++) queue[i]->cancel();
+    stopping = true;
+    pthread_cond_broadcast(&work);
+    pthread_mutex_unlock(&lock);
+    for(int i = 0; i < threads.size(); i++)
+        pthread_join(threads[i], NULL);
+    pthread_cond_destroy(&work);
+    pthread_mutex_destroy(&lock);
+}
+
+
+void SolveExecutor::submit(SolveHandle *h) {
+    pthread_mutex_lock(&lock);
+    if(head > 1024 && head * 2 > queue.size()) {    // Drop the handles already taken
+        int i, j;
+        for(i = head, j = 0; i < queue.size(); i++) queue[j++] = queue[i];
+        queue.shrink(i - j);
+        head = 0;
+    }
+    if(stopping) h->cancel();
+    queue.push(h);
+    pthread_cond_signal(&work);
+    pthread_mutex_unlock(&lock);
+}
+
+
+void *SolveExecutor::worker(void *executor) {
+    ((SolveExecutor *) executor)->run();
+    return NULL;
+}
+
+
+/**
+ * Run a step of the first search of the queue, then queue it again if it is not over. The searches
+ * left when the executor stops have been cancelled, and are run until they are over.
+ */
+
+void SolveExecutor::run() {
+    for(;;) {
+        pthread_mutex_lock(&lock);
+        while(head == queue.size() && !stopping) pthread_cond_wait(&work, &lock);
+        if(head == queue.size()) {
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        SolveHandle *h = queue[head++];
+        pthread_mutex_unlock(&lock);
+
+        pthread_mutex_lock(&h->lock);
+        if(h->cancelled) h->S.interrupt();
+        pthread_mutex_unlock(&h->lock);
+
+        lbool r = h->S.solveSteps(quantum);
+        if(h->S.solving)
+            submit(h);
+        else
+            h->finish(r);
+    }
+}
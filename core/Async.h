@@ -0,0 +1,73 @@
+#ifndef Minisat_Async_h
+#define Minisat_Async_h
+
+#include <pthread.h>
+
+#include "mtl/Vec.h"
+#include "core/Solver.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// Asynchronous solving -- many searches multiplexed on a few threads:
+//
+// 'Solver::solveAsync()' queues a search on a 'SolveExecutor'. A thread of the executor runs it by
+// steps of 'quantum' conflicts (see 'Solver::solveSteps()') and puts it back at the end of the queue
+// until it is over, so that no search holds a thread for long. The returned 'SolveHandle' gives the
+// result, and cancels the search.
+//
+// A solver runs at most one search at a time, and must not be used by the caller until its search
+// is over.
+
+    class SolveExecutor;
+
+    class SolveHandle {
+        friend class SolveExecutor;
+
+        Solver &S;
+        SolveExecutor &executor;
+        pthread_mutex_t lock;
+        pthread_cond_t finished;
+        bool done;
+        bool cancelled;
+        lbool result_;
+
+        void finish(lbool r);
+
+    public:
+        SolveHandle(Solver &s, SolveExecutor &e);
+        ~SolveHandle();                 // Cancels the search and waits for it to stop.
+
+        bool ready();                   // TRUE when the search is over.
+        lbool wait();                   // Wait for the result (l_Undef if cancelled).
+        lbool result();                 // The result if ready, l_Undef otherwise.
+        void cancel();                  // Stop the search (the result is then l_Undef, unless it was over).
+    };
+
+
+    class SolveExecutor {
+        friend class SolveHandle;
+
+        pthread_mutex_t lock;
+        pthread_cond_t work;
+        vec<pthread_t> threads;
+        vec<SolveHandle *> queue;
+        int head;                       // The first handle of the queue.
+        bool stopping;
+
+        static void *worker(void *executor);
+        void run();
+
+    public:
+        explicit SolveExecutor(int nb_threads, int64_t quantum_conflicts = 1000);
+        ~SolveExecutor();               // Cancels the searches left, and joins the threads.
+
+        const int64_t quantum;          // The number of conflicts of a step.
+
+        void submit(SolveHandle *h);    // Queue a search started by 'Solver::beginSolve()'.
+    };
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "utils/System.h"
+#include "core/Solver.h"
+
+using namespace CDCL;
+
+
+//=================================================================================================
+// Communities of the variable interaction graph
+//=================================================================================================
+
+namespace {
+    // A weighted graph in compressed rows, each edge being in the rows of its two ends. The weight of
+    // the edges inside a node (after aggregation) is in 'inner':
+    struct Graph {
+        vec<int64_t> start;    // The row of node i is [start[i], start[i+1][.
+        vec<int> adj;
+        vec<float> weight;
+        vec<double> inner;
+
+        int nodes() const { return inner.size(); }
+
+        double degree(int i) const {
+            double d = 2 * inner[i];
+            for(int64_t e = start[i]; e < start[i + 1]; e++) d += weight[e];
+            return d;
+        }
+    };
+
+    enum { check_period = 4096 };   // The nodes or clauses visited between two looks at the clock.
+
+
+    /**
+     * Move the nodes, one at a time, to the community of their neighbours giving the largest gain of
+     * modularity, until a pass over the nodes moves (almost) none of them or 'deadline' is reached
+     * (the clock is read every 'check_period' nodes, so that a pass can be cut short).
+     * @param g
+     * @param comm the community of each node, each node alone at first
+     * @param m2 twice the total weight of the edges
+     * @param deadline the CPU time at which to stop
+     * @return TRUE if a node moved
+     */
+
+    bool moveNodes(const Graph &g, vec<int> &comm, double m2, double deadline) {
+        int n = g.nodes();
+        vec<double> deg(n), tot(n), to_comm(n, -1);
+        vec<int> neighbours;
+        comm.clear();
+        for(int i = 0; i < n; i++) comm.push(i), deg[i] = tot[i] = g.degree(i);
+
+        bool moved = false, late = false;
+        while(!late) {
+            int moves = 0;
+            for(int i = 0; i < n && !late; i++) {
+                int c = comm[i];
+                neighbours.clear();
+                to_comm[c] = 0, neighbours.push(c);
+                for(int64_t e = g.start[i]; e < g.start[i + 1]; e++) {
+                    int d = comm[g.adj[e]];
+                    if(to_comm[d] < 0) to_comm[d] = 0, neighbours.push(d);
+                    to_comm[d] += g.weight[e];
+                }
+
+                tot[c] -= deg[i];           // The gain of joining community d is to_comm[d] - tot[d] * deg[i] / m2.
+                int best = c;
+                double best_gain = to_comm[c] - tot[c] * deg[i] / m2;
+                for(int k = 0; k < neighbours.size(); k++) {
+                    int d = neighbours[k];
+                    double gain = to_comm[d] - tot[d] * deg[i] / m2;
+                    if(gain > best_gain + 1e-12) best = d, best_gain = gain;
+                    to_comm[d] = -1;
+                }
+                tot[best] += deg[i];
+                if(best != c) comm[i] = best, moves++;
+                if(i % check_period == check_period - 1) late = cpuTime() > deadline;
+            }
+            if(moves > 0) moved = true;
+            if(moves <= n / 1000 || cpuTime() > deadline) break;
+        }
+        return moved;
+    }
+
+
+    // Number the communities from 0, and return their number:
+    int renumber(vec<int> &comm) {
+        vec<int> index(comm.size(), -1);
+        int nb = 0;
+        for(int i = 0; i < comm.size(); i++) {
+            if(index[comm[i]] < 0) index[comm[i]] = nb++;
+            comm[i] = index[comm[i]];
+        }
+        return nb;
+    }
+
+
+    // The graph of the 'nb' communities of 'g' (the edges between two communities are merged):
+    void aggregate(const Graph &g, const vec<int> &comm, int nb, Graph &to) {
+        vec<int> first(nb + 1, 0), members(g.nodes());
+        for(int i = 0; i < g.nodes(); i++) first[comm[i] + 1]++;
+        for(int c = 0; c < nb; c++) first[c + 1] += first[c];
+        vec<int> fill(nb);
+        for(int c = 0; c < nb; c++) fill[c] = first[c];
+        for(int i = 0; i < g.nodes(); i++) members[fill[comm[i]]++] = i;
+
+        to.start.clear(), to.adj.clear(), to.weight.clear(), to.inner.clear();
+        vec<double> to_comm(nb, -1);
+        vec<int> neighbours;
+        for(int c = 0; c < nb; c++) {
+            to.start.push(to.adj.size());
+            double inner = 0;
+            neighbours.clear();
+            for(int k = first[c]; k < first[c + 1]; k++) {
+                int i = members[k];
+                inner += g.inner[i];
+                for(int64_t e = g.start[i]; e < g.start[i + 1]; e++) {
+                    int d = comm[g.adj[e]];
+                    if(d == c) {
+                        inner += g.weight[e] / 2;   // (seen from both ends)
+                        continue;
+                    }
+                    if(to_comm[d] < 0) to_comm[d] = 0, neighbours.push(d);
+                    to_comm[d] += g.weight[e];
+                }
+            }
+            for(int k = 0; k < neighbours.size(); k++) {
+                to.adj.push(neighbours[k]);
+                to.weight.push((float) to_comm[neighbours[k]]);
+                to_comm[neighbours[k]] = -1;
+            }
+            to.inner.push(inner);
+        }
+        to.start.push(to.adj.size());
+    }
+
+
+    // The modularity of a partition of the nodes:
+    double partitionModularity(const Graph &g, const vec<int> &comm, int nb, double m2) {
+        vec<double> inner(nb, 0), tot(nb, 0);
+        for(int i = 0; i < g.nodes(); i++) {
+            inner[comm[i]] += 2 * g.inner[i];
+            for(int64_t e = g.start[i]; e < g.start[i + 1]; e++) {
+                tot[comm[i]] += g.weight[e];
+                if(comm[g.adj[e]] == comm[i]) inner[comm[i]] += g.weight[e];
+            }
+            tot[comm[i]] += 2 * g.inner[i];
+        }
+        double q = 0;
+        for(int c = 0; c < nb; c++) q += inner[c] / m2 - (tot[c] / m2) * (tot[c] / m2);
+        return q;
+    }
+}
+
+
+/**
+ * Compute the communities of the variable interaction graph with the Louvain method: the variables
+ * are moved between communities to improve the modularity, then each community becomes a node, and
+ * so on while the nodes move and 'comm_time' is not spent. Each clause weighs 1 in the graph: a
+ * clause of at most 'max_clique' unassigned variables links each pair of them, a longer one only
+ * links its variables in a cycle, in a shuffled order (so that the graph has at most 'max_clique' - 1
+ * edges per literal).
+ * If the graph needs more than 'max_edges' edges, or more than the memory left under
+ * 'mem_soft_limit', or if it is not built within 'comm_time', no variable gets a community.
+ * Must be called at decision level 0.
+ */
+
+void Solver::computeCommunities() {
+    static const int max_clique = 8;
+    static const int64_t max_edges = (int64_t) 1 << 25;     // (counted in both rows, 8 bytes each)
+    assert(decisionLevel() == 0);
+    double start_time = cpuTime();
+    double deadline = start_time + comm_time;
+
+    community.clear();
+    community.growTo(nVars(), -1);
+    nb_communities = 0;
+    modularity = 0;
+    curr_community = -1;
+
+    // The graph of the variables (the edges repeated by several clauses are merged by the first
+    // aggregation):
+    int64_t budget = max_edges;
+    if(mem_soft_limit > 0) {
+        uint64_t used = memoryFootprint();
+        int64_t left = used >= mem_soft_limit ? 0 : (int64_t) ((mem_soft_limit - used) / (2 * (sizeof(int) + sizeof(float))));
+        if(left < budget) budget = left;                    // (room for the graph and its first aggregation)
+    }
+    Graph g;
+    g.start.growTo(nVars() + 1, 0);
+    g.inner.growTo(nVars(), 0);
+    vec<Var> vs;
+    vec<int64_t> fill;
+    bool out_of_budget = false;
+    for(int pass = 0; pass < 2 && !out_of_budget; pass++) {
+        if(pass == 1) {
+            for(Var v = 0; v < nVars(); v++) g.start[v + 1] += g.start[v];
+            g.adj.growTo((int) g.start[nVars()]);
+            g.weight.growTo((int) g.start[nVars()]);
+            g.start.copyTo(fill);
+        }
+        int64_t edges = 0;
+        for(int i = 0; i < clauses.size() && !out_of_budget; i++) {
+            const Clause &c = ca[clauses[i]];
+            vs.clear();
+            for(int j = 0; j < c.size(); j++)
+                if(value(c[j]) == l_Undef) vs.push(var(c[j]));
+            int k = vs.size();
+            if(k < 2) continue;
+            if(k <= max_clique) {
+                float w = (float) (2.0 / ((double) k * (k - 1)));
+                for(int a = 0; a < k; a++)
+                    if(pass == 0) g.start[vs[a] + 1] += k - 1;
+                    else
+                        for(int b = 0; b < k; b++)
+                            if(b != a) g.adj[(int) fill[vs[a]]] = vs[b], g.weight[(int) fill[vs[a]]++] = w;
+                edges += (int64_t) k * (k - 1);
+            } else {
+                // The literals are sorted, so the cycle follows a shuffle (the same in both passes):
+                uint32_t r = (uint32_t) i * 2654435761u + 1;
+                for(int a = k - 1; a > 0; a--) {
+                    r ^= r << 13, r ^= r >> 17, r ^= r << 5;
+                    int b = (int) (r % (uint32_t) (a + 1));
+                    Var t = vs[a]; vs[a] = vs[b]; vs[b] = t;
+                }
+                float w = (float) (1.0 / k);
+                for(int a = 0; a < k; a++) {
+                    Var x = vs[a], y = vs[(a + 1) % k];
+                    if(pass == 0) g.start[x + 1]++, g.start[y + 1]++;
+                    else {
+                        g.adj[(int) fill[x]] = y, g.weight[(int) fill[x]++] = w;
+                        g.adj[(int) fill[y]] = x, g.weight[(int) fill[y]++] = w;
+                    }
+                }
+                edges += 2 * k;
+            }
+            if(edges > budget || (i % check_period == check_period - 1 && cpuTime() > deadline))
+                out_of_budget = true;
+        }
+    }
+    if(out_of_budget) {
+        if(verbosity >= 1) printf("c communities: none (the graph is over its edge, memory or time budget)\n");
+        return;
+    }
+
+    double m2 = 0;
+    for(int e = 0; e < g.weight.size(); e++) m2 += g.weight[e];
+    for(Var v = 0; v < nVars(); v++) community[v] = v;
+    nb_communities = nVars();
+    if(m2 == 0) return;
+
+    // Move the nodes, then aggregate the communities, level by level:
+    Graph next;
+    vec<int> comm;
+    for(;;) {
+        bool moved = moveNodes(g, comm, m2, deadline);
+        int nb = renumber(comm);
+        for(Var v = 0; v < nVars(); v++) community[v] = comm[community[v]];
+        nb_communities = nb;
+        modularity = partitionModularity(g, comm, nb, m2);
+        if(!moved || nb == g.nodes() || cpuTime() > deadline) break;
+        aggregate(g, comm, nb, next);
+        next.start.moveTo(g.start), next.adj.moveTo(g.adj), next.weight.moveTo(g.weight), next.inner.moveTo(g.inner);
+    }
+
+    if(verbosity >= 1)
+        printf("c communities: %d (modularity %.3f, %.2f s)\n", nb_communities, modularity, cpuTime() - start_time);
+}
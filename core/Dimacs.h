@@ -60,6 +60,44 @@ static void parse_DIMACS(gzFile input_stream, Solver& S) {
     StreamBuffer in(input_stream);
     parse_DIMACS_main(in, S); }
 
+//=================================================================================================
+// Incremental CNF (iCNF) Parser:
+//
+// The header is 'p inccnf' (without counts), and clauses are interleaved with assumption lines
+// 'a <lits> 0'. The formula read so far is solved under the assumptions of each such line, by
+// 'query(assumps)', which returns FALSE to stop reading.
+
+template<class B, class Solver, class Query>
+static int parse_ICNF_main(B& in, Solver& S, Query& query) {
+    vec<Lit> lits;
+    int queries = 0;
+    for (;;){
+        skipWhitespace(in);
+        if (*in == EOF) break;
+        else if (*in == 'p'){
+            if (!eagerMatch(in, "p inccnf"))
+                printf("PARSE ERROR! Unexpected char: %c\n", *in), exit(3);
+        } else if (*in == 'c')
+            skipLine(in);
+        else if (*in == 'a'){
+            ++in;
+            readClause(in, S, lits);
+            queries++;
+            if (!query(lits)) break;
+        } else{
+            readClause(in, S, lits);
+            S.addClause_(lits); }
+    }
+    return queries;
+}
+
+// Reads and solves an incremental problem. Returns the number of queries:
+//
+template<class Solver, class Query>
+static int parse_ICNF(gzFile input_stream, Solver& S, Query& query) {
+    StreamBuffer in(input_stream);
+    return parse_ICNF_main(in, S, query); }
+
 //=================================================================================================
 }
 
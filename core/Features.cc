@@ -0,0 +1,267 @@
+#include <math.h>
+#include <string.h>
+
+#include "utils/Options.h"
+#include "core/Features.h"
+#include "core/Solver.h"
+
+using namespace CDCL;
+
+
+const char *CDCL::feature_names[nb_features] = {
+        "vars", "clauses", "ratio", "size-mean", "size-std", "size-max", "binary", "ternary", "horn", "pos-lits",
+        "deg-mean", "deg-std", "deg-max", "fixed", "probe-implied", "probe-failed"
+};
+
+
+int CDCL::featureIndex(const char *name) {
+    for(int i = 0; i < nb_features; i++)
+        if(strcmp(name, feature_names[i]) == 0) return i;
+    return -1;
+}
+
+
+//=================================================================================================
+// Feature extraction
+//=================================================================================================
+
+/**
+ * Compute the instance features (see 'core/Features.h'). Must be called at decision level 0.
+ * @param features the values, indexed by the 'feat_*' constants
+ * @param samples the number of variables whose degree in the variable interaction graph is computed
+ * @param probes the number of variables whose two literals are probed at level 1
+ */
+
+void Solver::computeFeatures(vec<double> &features, int samples, int probes) {
+    assert(decisionLevel() == 0);
+    features.clear();
+    features.growTo(nb_features, 0);
+
+    features[feat_vars] = nVars();
+    features[feat_clauses] = nClauses();
+    features[feat_ratio] = nVars() == 0 ? 0 : (double) nClauses() / nVars();
+    features[feat_fixed] = nVars() == 0 ? 0 : (double) trail.size() / nVars();
+    if(clauses.size() == 0) return;
+
+    // Clause size distribution and literal polarities:
+    double sum = 0, sum2 = 0;
+    int maxsize = 0, binaries = 0, ternaries = 0, horns = 0;
+    uint64_t nlits = 0, npositive = 0;
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        int positive = 0;
+        for(int j = 0; j < c.size(); j++)
+            if(!sign(c[j])) positive++;
+        sum += c.size();
+        sum2 += (double) c.size() * c.size();
+        if(c.size() > maxsize) maxsize = c.size();
+        if(c.size() == 2) binaries++;
+        if(c.size() == 3) ternaries++;
+        if(positive <= 1) horns++;
+        nlits += c.size();
+        npositive += positive;
+    }
+    double n = clauses.size();
+    features[feat_size_mean] = sum / n;
+    features[feat_size_std] = sqrt(fmax(0, sum2 / n - (sum / n) * (sum / n)));
+    features[feat_size_max] = maxsize;
+    features[feat_binary] = binaries / n;
+    features[feat_ternary] = ternaries / n;
+    features[feat_horn] = horns / n;
+    features[feat_pos_lits] = (double) npositive / nlits;
+
+    // Degrees in the variable interaction graph. Occurrences are stored in compressed rows, and only
+    // a regular sample of the variables is visited to bound the work on dense instances:
+    vec<int> start(nVars() + 1, 0);
+    vec<int> occs((int) nlits);
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        for(int j = 0; j < c.size(); j++) start[var(c[j]) + 1]++;
+    }
+    for(int v = 0; v < nVars(); v++) start[v + 1] += start[v];
+    vec<int> pos;
+    start.copyTo(pos);
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        for(int j = 0; j < c.size(); j++) occs[pos[var(c[j])]++] = i;
+    }
+
+    vec<int> stamp(nVars(), -1);
+    int step = nVars() > samples ? nVars() / samples : 1, maxdeg = 0, nsampled = 0;
+    double dsum = 0, dsum2 = 0;
+    for(Var v = 0; v < nVars(); v += step) {
+        int deg = 0;
+        for(int k = start[v]; k < start[v + 1]; k++) {
+            const Clause &c = ca[clauses[occs[k]]];
+            for(int j = 0; j < c.size(); j++) {
+                Var w = var(c[j]);
+                if(w != v && stamp[w] != v) stamp[w] = v, deg++;
+            }
+        }
+        dsum += deg;
+        dsum2 += (double) deg * deg;
+        if(deg > maxdeg) maxdeg = deg;
+        nsampled++;
+    }
+    features[feat_deg_mean] = dsum / nsampled;
+    features[feat_deg_std] = sqrt(fmax(0, dsum2 / nsampled - (dsum / nsampled) * (dsum / nsampled)));
+    features[feat_deg_max] = maxdeg;
+
+    // Short probing run: propagate both literals of some variables at level 1. The saved phases
+    // are restored afterwards, the search should not start from the probed polarities:
+    if(!ok) return;
+    vec<char> saved_polarity;
+    polarity.copyTo(saved_polarity);
+    int probed = 0, failed = 0;
+    double implied = 0;
+    int pstep = nVars() > probes ? nVars() / probes : 1;
+    for(Var v = 0; v < nVars(); v += pstep) {
+        if(value(v) != l_Undef) continue;
+        for(int s = 0; s < 2; s++) {
+            newDecisionLevel();
+            int before = trail.size();
+            uncheckedEnqueue(mkLit(v, s));
+            if(propagate() != CRef_Undef)
+                failed++;
+            else
+                implied += trail.size() - before - 1;
+            probed++;
+            cancelUntil(0);
+        }
+    }
+    saved_polarity.moveTo(polarity);
+    if(probed > 0) {
+        features[feat_probe_failed] = (double) failed / probed;
+        features[feat_probe_implied] = probed == failed ? 0 : implied / (probed - failed) / nVars();
+    }
+}
+
+
+//=================================================================================================
+// Configuration selection
+//=================================================================================================
+
+enum { op_lt, op_le, op_gt, op_ge };
+
+static const char *separators = " \t\r\n";
+
+
+ConfigTable::~ConfigTable() {
+    for(int i = 0; i < configs.size(); i++) {
+        free(configs[i].name);
+        for(int j = 0; j < configs[i].args.size(); j++) free(configs[i].args[j]);
+    }
+}
+
+
+int ConfigTable::lookup(const char *name) const {
+    for(int i = 0; i < configs.size(); i++)
+        if(strcmp(configs[i].name, name) == 0) return i;
+    return -1;
+}
+
+
+/**
+ * Read a rule table.
+ * @param file the name of the rule table
+ * @return false if the file can not be read or is malformed
+ */
+
+bool ConfigTable::load(const char *file) {
+    FILE *in = fopen(file, "r");
+    if(in == NULL) {
+        fprintf(stderr, "ERROR! Could not open rule table: %s\n", file);
+        return false;
+    }
+
+    char line[4096];
+    const char *error = NULL;
+    int lineno = 0;
+    while(error == NULL && fgets(line, sizeof(line), in) != NULL) {
+        lineno++;
+        char *tok = strtok(line, separators);
+        if(tok == NULL || tok[0] == '#') continue;
+
+        if(strcmp(tok, "config") == 0) {
+            char *name = strtok(NULL, separators);
+            if(name == NULL) { error = "missing configuration name"; break; }
+            if(lookup(name) != -1) { error = "configuration defined twice"; break; }
+            configs.push();
+            configs.last().name = strdup(name);
+            while((tok = strtok(NULL, separators)) != NULL)
+                configs.last().args.push(strdup(tok));
+
+        } else if(strcmp(tok, "rule") == 0) {
+            char *name = strtok(NULL, separators);
+            int config = name == NULL ? -1 : lookup(name);
+            if(config == -1) { error = "unknown configuration"; break; }
+            rules.push();
+            rules.last().config = config;
+            while(error == NULL && (tok = strtok(NULL, separators)) != NULL) {
+                char *op = strtok(NULL, separators);
+                char *val = strtok(NULL, separators);
+                char *end = NULL;
+                Condition cond;
+                cond.feature = featureIndex(tok);
+                cond.op = op == NULL ? -1
+                        : strcmp(op, "<") == 0 ? op_lt : strcmp(op, "<=") == 0 ? op_le
+                        : strcmp(op, ">") == 0 ? op_gt : strcmp(op, ">=") == 0 ? op_ge : -1;
+                if(val != NULL) cond.value = strtod(val, &end);
+                if(cond.feature == -1) error = "unknown feature";
+                else if(cond.op == -1) error = "bad comparison operator";
+                else if(val == NULL || *end != '\0') error = "bad threshold";
+                else rules.last().conds.push(cond);
+            }
+
+        } else if(strcmp(tok, "default") == 0) {
+            char *name = strtok(NULL, separators);
+            if(name == NULL || (default_config = lookup(name)) == -1) error = "unknown configuration";
+
+        } else
+            error = "unknown directive";
+    }
+    fclose(in);
+
+    if(error != NULL) {
+        fprintf(stderr, "ERROR! %s:%d: %s.\n", file, lineno, error);
+        return false;
+    }
+    return true;
+}
+
+
+bool ConfigTable::holds(const Condition &c, const vec<double> &features) const {
+    double f = features[c.feature];
+    switch(c.op) {
+        case op_lt: return f < c.value;
+        case op_le: return f <= c.value;
+        case op_gt: return f > c.value;
+        default:    return f >= c.value;
+    }
+}
+
+
+int ConfigTable::select(const vec<double> &features) const {
+    for(int i = 0; i < rules.size(); i++) {
+        bool match = true;
+        for(int j = 0; match && j < rules[i].conds.size(); j++)
+            match = holds(rules[i].conds[j], features);
+        if(match) return rules[i].config;
+    }
+    return default_config;
+}
+
+
+/**
+ * Parse the options of a configuration (as if given on the command line). The solver must then
+ * re-read them with 'Solver::updateParameters()'.
+ */
+
+void ConfigTable::apply(int config) const {
+    vec<char *> argv;
+    argv.push((char *) configs[config].name);    // (placeholder for the program name)
+    for(int i = 0; i < configs[config].args.size(); i++)
+        argv.push(configs[config].args[i]);
+    int argc = argv.size();
+    parseOptions(argc, (char **) argv, true);
+}
@@ -0,0 +1,85 @@
+#ifndef Minisat_Features_h
+#define Minisat_Features_h
+
+#include "mtl/Vec.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// Instance features -- cheap syntactic and probing measures computed after parsing
+// (see 'Solver::computeFeatures()'):
+
+    enum {
+        feat_vars = 0,        // Number of variables.
+        feat_clauses,         // Number of original clauses.
+        feat_ratio,           // Clauses / variables.
+        feat_size_mean,       // Mean clause size.
+        feat_size_std,        // Standard deviation of the clause size.
+        feat_size_max,        // Largest clause size.
+        feat_binary,          // Fraction of binary clauses.
+        feat_ternary,         // Fraction of ternary clauses.
+        feat_horn,            // Fraction of Horn clauses (at most one positive literal).
+        feat_pos_lits,        // Fraction of positive literals.
+        feat_deg_mean,        // Mean degree in the variable interaction graph (sampled).
+        feat_deg_std,         // Standard deviation of the degree (sampled).
+        feat_deg_max,         // Largest degree (sampled).
+        feat_fixed,           // Fraction of variables fixed at level 0.
+        feat_probe_implied,   // Mean fraction of variables implied by a single probed literal.
+        feat_probe_failed,    // Fraction of probed literals leading to a conflict.
+        nb_features
+    };
+
+    extern const char *feature_names[nb_features];
+
+    int featureIndex(const char *name);   // -1 if 'name' is not a feature.
+
+
+//=================================================================================================
+// ConfigTable -- selects a named configuration from instance features:
+//
+// The rule table is a text file. Each line is either empty, a comment (starting with '#') or one of:
+//
+//   config  <name> [-option=value ...]                  (options are parsed as on the command line)
+//   rule    <name> <feature> <op> <value> [<feature> <op> <value> ...]    (op is <, <=, > or >=)
+//   default <name>
+//
+// Rules are tried in order, the first rule whose conditions all hold selects its configuration.
+
+    class ConfigTable {
+        struct Config {
+            char *name;
+            vec<char *> args;
+        };
+
+        struct Condition {
+            int feature;
+            int op;
+            double value;
+        };
+
+        struct Rule {
+            int config;
+            vec<Condition> conds;
+        };
+
+        vec<Config> configs;
+        vec<Rule> rules;
+        int default_config;
+
+        int lookup(const char *name) const;
+        bool holds(const Condition &c, const vec<double> &features) const;
+
+    public:
+        ConfigTable() : default_config(-1) {}
+        ~ConfigTable();
+
+        bool load(const char *file);                        // Returns FALSE (with a message) on a malformed table.
+        int select(const vec<double> &features) const;     // Index of the selected configuration, -1 if none.
+        const char *name(int config) const { return configs[config].name; }
+        void apply(int config) const;                       // Parse the options of a configuration.
+    };
+
+//=================================================================================================
+}
+
+#endif
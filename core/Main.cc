@@ -8,21 +8,78 @@
 #include "utils/Options.h"
 #include "core/Dimacs.h"
 #include "core/Solver.h"
+#include "core/Features.h"
+#include "core/ResultStore.h"
 
 using namespace CDCL;
 
 //=================================================================================================
 
 
+static void printLearntGroups(const char *title, const LearntLifetimes::Group *groups, bool by_lbd) {
+    printf("c\nc learnt clauses by %-9s     learnt    deleted   unused %%   lifetime       uses      props  last LBD\n", title);
+    for(int g = 0; g < LearntLifetimes::nb_groups; g++) {
+        const LearntLifetimes::Group &G = groups[g];
+        if(G.learnt == 0) continue;
+        char label[32];
+        if(by_lbd)
+            snprintf(label, sizeof(label), g + 1 < LearntLifetimes::nb_groups ? "%d" : "%d+", g + 1);
+        else
+            snprintf(label, sizeof(label), g + 1 < LearntLifetimes::nb_groups ? "%d-%d" : "%d+", 1 << g, (2 << g) - 1);
+        printf("c   %-26s %10" PRIu64 " %10" PRIu64 " %10.2f %10.1f %10.2f %10.2f %9.2f\n", label, G.learnt, G.deleted,
+               G.deleted == 0 ? 0 : G.unused * 100.0 / G.deleted, G.lifetime.mean(), G.uses.mean(), G.propagations.mean(), G.lbd.mean());
+    }
+}
+
+
 void printStats(Solver &solver) {
     double cpu_time = cpuTime();
     printf("c\nc\nc restarts              : %"PRIu64"\n", solver.starts);
     printf("c conflicts             : %-12"PRIu64"   (%.0f /sec)\n", solver.conflicts, solver.conflicts / cpu_time);
-    printf("c decisions             : %-12"PRIu64"   (%.0f /sec)\n", solver.decisions, solver.decisions / cpu_time);
+    printf("c decisions             : %-12"PRIu64"   (%4.2f %% random) (%.0f /sec)\n", solver.decisions, (solver.decisions == 0 ? 0 : (float) solver.rnd_decisions * 100 / (float) solver.decisions), solver.decisions / cpu_time);
     printf("c propagations          : %-12"PRIu64"   (%.0f /sec)\n", solver.propagations, solver.propagations / cpu_time);
     printf("c\n");
     printf("c nb reduce DB          : %-12"PRIu64" \n", solver.nb_reducedb);
     printf("c removed clauses       : %-12"PRIu64"   (%"PRIu64" %% of total)\n", solver.nb_removed_clauses, (solver.conflicts==0 ? 0 : (solver.nb_removed_clauses*100) / solver.conflicts));
+    printf("c duplicate clauses     : %-12"PRIu64"   (%"PRIu64" learnt)\n", solver.nb_duplicates, solver.nb_duplicate_learnts);
+    printf("c memory reductions     : %-12"PRIu64"   (%"PRIu64" after an allocation failure)\n", solver.nb_mem_reductions, solver.nb_oom_recoveries);
+    if(solver.inprocess)
+        printf("c transitive binaries   : %-12" PRIu64 "   (%" PRIu64 " hyper-binary resolvents, %" PRIu64 " failed literals)\n",
+               solver.nb_transitive, solver.nb_hyper_binaries, solver.nb_failed_literals);
+    if(solver.comm_branch || solver.comm_reduce)
+        printf("c communities           : %-12d   (modularity %.3f)\n", solver.nb_communities, solver.modularity);
+    for(int i = 0; i < solver.arms.size(); i++)
+        printf("c bandit arm %d          : %-12d   (decay %.2f, unit %d, reward %.3f)\n", i, solver.arms[i].pulls,
+               solver.arms[i].var_decay, solver.arms[i].restart_unit, solver.arms[i].reward);
+    if(solver.prop_stats) {
+        const PropagationStats &ps = solver.propagation_stats;
+        uint64_t visited = ps.watchers == 0 ? 1 : ps.watchers;
+        printf("c\n");
+        printf("c watchers visited      : %-12" PRIu64 "   (%.2f %% blocker true, %.2f %% other watch true, %.2f %% dereferenced)\n",
+               ps.watchers, ps.blocker_hits * 100.0 / visited, ps.first_hits * 100.0 / visited,
+               (ps.watchers - ps.blocker_hits) * 100.0 / visited);
+        printf("c binary watchers       : %-12" PRIu64 "   (%.2f %% other literal true)\n",
+               ps.bin_watchers, ps.bin_true * 100.0 / (ps.bin_watchers == 0 ? 1 : ps.bin_watchers));
+        ps.watch_lists.print(stdout, "watch list lengths");
+        ps.clause_sizes.print(stdout, "visited clause sizes");
+        ps.replacements.print(stdout, "new watch searches");
+    }
+    if(solver.track_learnts) {
+        printLearntGroups("LBD", solver.learnt_lifetimes.by_lbd, true);
+        printLearntGroups("size", solver.learnt_lifetimes.by_size, false);
+        printf("c   (lifetime, uses, propagations and last LBD are means over the deleted clauses)\n");
+    }
+    printf("c\n");
+    MemoryUsage mem;
+    solver.memoryUsage(mem);
+    printf("c clause arena          : %.2f MB (%.2f MB live, %.2f MB wasted)\n", mem.arena / 1048576.0, mem.arena_live / 1048576.0, mem.arena_wasted / 1048576.0);
+    printf("c watch lists           : %.2f MB\n", mem.watches / 1048576.0);
+    printf("c clause lists          : %.2f MB\n", mem.clause_lists / 1048576.0);
+    printf("c variables             : %.2f MB\n", mem.variables / 1048576.0);
+    printf("c trail                 : %.2f MB\n", mem.trail / 1048576.0);
+    printf("c heap                  : %.2f MB\n", mem.heap / 1048576.0);
+    printf("c other                 : %.2f MB\n", mem.other / 1048576.0);
+    printf("c solver memory         : %.2f MB (%.2f MB peak for the process)\n", mem.total() / 1048576.0, memUsedPeak());
     printf("c\n");
     printf("c CPU time              : %g s\n", cpu_time);
 }
@@ -51,6 +108,185 @@ static void SIGINT_exit(int signum) {
 }
 
 
+//=================================================================================================
+// Simplified formulas:
+
+
+// FNV-1a hash of the (decompressed) content of a file, 0 if it can not be read. 'check' is set to a
+// second, independent hash of the content (a rotate-multiply hash, which also covers the length):
+static uint64_t hashFile(const char *path, uint64_t &check) {
+    gzFile in = gzopen(path, "rb");
+    if(in == NULL) return 0;
+    static unsigned char buf[1 << 16];
+    uint64_t h = 14695981039346656037ULL, c = 0x243F6A8885A308D3ULL, len = 0;
+    int n;
+    while((n = gzread(in, buf, sizeof(buf))) > 0) {
+        for(int i = 0; i < n; i++) {
+            h = (h ^ buf[i]) * 1099511628211ULL;
+            c = ((c << 23 | c >> 41) + buf[i]) * 0x9E3779B97F4A7C15ULL;
+        }
+        len += n;
+    }
+    gzclose(in);
+    check = c ^ len;
+    return h;
+}
+
+
+// The identity of a cached simplified formula: the second hash of the input file, to confirm the
+// match of its FNV-1a hash, and the hashes of the input formula ('FormulaHash'), which key the
+// result cache whether the formula was read from the input or from the preprocessing cache:
+struct CachedFormula {
+    uint64_t input_check;
+    uint64_t hash, check;
+};
+
+
+// Write the simplified formula to 'path', and the level-0 assignments to 'path.rec' (after the
+// identity of the formula, if any). Both are written to temporary files first, so that a concurrent
+// reader never sees a partial formula:
+static bool writeSimplified(Solver &S, const char *path, const CachedFormula *id = NULL) {
+    char tmp[4096], rec[4096], rec_tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp%d", path, (int) getpid());
+    snprintf(rec, sizeof(rec), "%s.rec", path);
+    snprintf(rec_tmp, sizeof(rec_tmp), "%s.tmp%d", rec, (int) getpid());
+
+    FILE *f = fopen(rec_tmp, "wb");
+    if(f == NULL) return false;
+    if(id != NULL) fprintf(f, "c identity %016" PRIx64 " %016" PRIx64 " %016" PRIx64 "\n", id->input_check, id->hash, id->check);
+    S.writeFixed(f);
+    bool written = fclose(f) == 0;
+    if(written && (f = fopen(tmp, "wb")) != NULL) {
+        S.toDimacs(f);
+        written = fclose(f) == 0;
+    } else
+        written = false;
+
+    if(written && rename(rec_tmp, rec) == 0 && rename(tmp, path) == 0) return true;
+    remove(tmp), remove(rec_tmp);
+    return false;
+}
+
+
+// Load a formula written by 'writeSimplified()' with the identity 'id': the level-0 assignments first,
+// as they also give the number of variables, then the clauses. Nothing is loaded if the input check of
+// the identity differs from the one of 'id' (the hashes of 'id' are then set from the file):
+template<class Solver>
+static bool readSimplified(Solver &S, const char *path, CachedFormula &id) {
+    char rec[4096];
+    snprintf(rec, sizeof(rec), "%s.rec", path);
+    gzFile in = gzopen(rec, "rb");
+    if(in == NULL) return false;
+    gzFile cnf = gzopen(path, "rb");
+    if(cnf == NULL) {
+        gzclose(in);
+        return false;
+    }
+
+    StreamBuffer buf(in);
+    if(!eagerMatch(buf, "c identity") || parseHex(buf) != id.input_check) {
+        gzclose(in), gzclose(cnf);
+        return false;
+    }
+    id.hash = parseHex(buf);
+    id.check = parseHex(buf);
+    vec<Lit> lits;
+    for(;;) {
+        skipWhitespace(buf);
+        if(*buf == EOF) break;
+        if(eagerMatch(buf, "p cnf")) {
+            int vars = parseInt(buf);
+            parseInt(buf);
+            while(S.nVars() < vars) S.newVar();
+        } else {
+            readClause(buf, S, lits);
+            S.addClause_(lits);
+        }
+    }
+    gzclose(in);
+    parse_DIMACS(cnf, S);
+    gzclose(cnf);
+    return true;
+}
+
+
+// Write the result, and the model if any:
+static void writeResult(FILE *res, lbool ret, const vec<lbool> &model) {
+    if(ret == l_True) {
+        fprintf(res, "SAT\n");
+        for(int i = 0; i < model.size(); i++)
+            if(model[i] != l_Undef)
+                fprintf(res, "%s%s%d", (i == 0) ? "" : " ", (model[i] == l_True) ? "" : "-", i + 1);
+        fprintf(res, " 0\n");
+    } else if(ret == l_False)
+        fprintf(res, "UNSAT\n");
+    else
+        fprintf(res, "INDET\n");
+}
+
+
+static void writeResult(const char *file, lbool ret, const vec<lbool> &model) {
+    FILE *res = fopen(file, "wb");
+    if(res == NULL) {
+        printf("c WARNING! Could not open result file: %s\n", file);
+        return;
+    }
+    writeResult(res, ret, model);
+    fclose(res);
+}
+
+
+//=================================================================================================
+// Incremental problems:
+
+
+// Is the input an incremental problem (iCNF)? Only its header is read:
+static bool isIncremental(const char *file) {
+    gzFile in = gzopen(file, "rb");
+    if(in == NULL) return false;
+    char line[256];
+    bool icnf = false;
+    while(gzgets(in, line, sizeof(line)) != NULL) {
+        if(line[0] == 'c' || line[0] == '\n') continue;
+        icnf = strncmp(line, "p inccnf", 8) == 0;
+        break;
+    }
+    gzclose(in);
+    return icnf;
+}
+
+
+// Solves each query of an incremental problem, printing its result (and the failed assumptions):
+struct IncrementalQuery {
+    Solver &S;
+    FILE *res;
+    lbool last;
+
+    IncrementalQuery(Solver &s, FILE *r) : S(s), res(r), last(l_Undef) {}
+
+    bool operator()(const vec<Lit> &assumps) {
+        uint64_t conflicts = S.conflicts;
+        double time = cpuTime();
+        last = S.solve(assumps);
+        if(S.verbosity > 0) {
+            printf("c query with %d assumptions: %" PRIu64 " conflicts, %.2f s\n", assumps.size(), S.conflicts - conflicts,
+                   cpuTime() - time);
+            if(last == l_False && S.conflict.size() > 0) {
+                printf("c failed assumptions:");
+                for(int i = 0; i < S.conflict.size(); i++)
+                    printf(" %s%d", sign(S.conflict[i]) ? "" : "-", var(S.conflict[i]) + 1);
+                printf(" 0\n");
+            }
+        }
+        printf(last == l_True ? "s SATISFIABLE\n" : last == l_False ? "s UNSATISFIABLE\n" : "s INDETERMINATE\n");
+        if(res != NULL) writeResult(res, last, S.model);
+        return last != l_Undef;
+    }
+};
+
+
+
+
 //=================================================================================================
 // Main:
 
@@ -69,6 +305,15 @@ int main(int argc, char **argv) {
         IntOption verb("MAIN", "verb", "Verbosity level (0=silent, 1=some, 2=more).", 1, IntRange(0, 2));
         IntOption cpu_lim("MAIN", "cpu-lim", "Limit on CPU time allowed in seconds.\n", INT32_MAX, IntRange(0, INT32_MAX));
         IntOption mem_lim("MAIN", "mem-lim", "Limit on memory usage in megabytes.\n", INT32_MAX, IntRange(0, INT32_MAX));
+        BoolOption incremental("MAIN", "icnf", "The input is incremental (iCNF): solve at each assumption line (detected for files).", false);
+        BoolOption features("MAIN", "features", "Print the instance features after parsing.", false);
+        StringOption config_table("MAIN", "config-table", "Select the solver configuration from the instance features using this rule table.");
+        StringOption proof_file("PROOF", "proof", "Write a refutation to this file.");
+        BoolOption lrat_proof("PROOF", "lrat", "Write the refutation in LRAT (with clause identifiers and hints) instead of DRAT.", false);
+        BoolOption binary_proof("PROOF", "binary-proof", "Write the refutation in binary form.", true);
+        StringOption dimacs_out("MAIN", "dimacs-out", "Write the formula simplified at level 0 to this file (and the fixed literals to <file>.rec).");
+        StringOption result_cache("MAIN", "result-cache", "Directory of results, reused when solving the same formula again (not with -proof).");
+        StringOption preproc_cache("MAIN", "preproc-cache", "Directory of simplified formulas, reused when solving the same input again (not with -proof).");
 
         printf("c\nc minicdcl - Heavily based on Minisat with only essentials components. SAT Summer School 2018\n");
         parseOptions(argc, argv, true);
@@ -78,6 +323,13 @@ int main(int argc, char **argv) {
 
         S.verbosity = verb;
 
+        if(proof_file) {
+            FILE *out = fopen(proof_file, "wb");
+            if(out == NULL)
+                printf("c ERROR! Could not open proof file: %s\n", (const char *) proof_file), exit(1);
+            S.setProof(new Proof(out, lrat_proof, binary_proof));
+        }
+
         solver = &S;
         // Use signal handlers that forcibly quit until the solver will be able to respond to
         // interrupts:
@@ -111,16 +363,77 @@ int main(int argc, char **argv) {
         if(argc == 1)
             printf("c Reading from standard input... Use '--help' for help.\n");
 
-        gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
-        if(in == NULL)
-            printf("c ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
+        // Incremental problems are solved while they are read, keeping the learnt clauses between queries:
+        if(incremental || (argc > 1 && isIncremental(argv[1]))) {
+            gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
+            if(in == NULL)
+                printf("c ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
+            FILE *res = argc >= 3 ? fopen(argv[2], "wb") : NULL;
+            signal(SIGINT, SIGINT_interrupt);
+            signal(SIGXCPU, SIGINT_interrupt);
+
+            IncrementalQuery query(S, res);
+            if(parse_ICNF(in, S, query) == 0) {
+                vec<Lit> none;
+                query(none);
+            }
+            gzclose(in);
+            if(res != NULL) fclose(res);
+            if(S.verbosity > 0) printStats(S);
+            exit(query.last == l_True ? 10 : query.last == l_False ? 20 : 0);
+        }
+
+        FormulaHash<Solver> H(S);                // (hashes the clauses given to the solver)
+
+        // The simplified formulas are cached under a hash of the input:
+        char cached[4096] = "";
+        bool from_cache = false;
+        CachedFormula id = {0, 0, 0};
+        if(preproc_cache && argc > 1) {
+            uint64_t h = hashFile(argv[1], id.input_check);
+            if(h != 0) snprintf(cached, sizeof(cached), "%s/%016" PRIx64 ".cnf", (const char *) preproc_cache, h);
+            if(h != 0 && !proof_file) from_cache = readSimplified(H, cached, id);
+        }
 
         if(S.verbosity > 0) {
             printf("c \n");
             printf("c \n");
         }
-        parse_DIMACS(in, S);
-        gzclose(in);
+        if(from_cache) {
+            if(S.verbosity > 0) printf("c Simplified formula read from %s\n", cached);
+        } else {
+            gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
+            if(in == NULL)
+                printf("c ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
+            parse_DIMACS(in, H);
+            gzclose(in);
+            id.hash = H.hash(), id.check = H.check();
+        }
+
+        // Answer from the result cache, keyed by the hash of the input formula (also when the simplified
+        // formula was read from the cache). The model is checked, as the formula is only known by its
+        // hash, and an unsatisfiable result needs the second hash to match:
+        ResultStore *results = result_cache ? new DirectoryStore(result_cache) : NULL;
+        ResultStore::Entry entry;
+        if(results != NULL && !proof_file && results->lookup(id.hash, entry)
+           && (entry.result == l_False ? entry.check == id.check : S.checkModel(entry.model))) {
+            if(S.verbosity > 0) {
+                printf("c Result read from %s (formula %016" PRIx64 ")\n", (const char *) result_cache, id.hash);
+                if(entry.result == l_False && entry.proof.size() > 1)
+                    printf("c Refutation in %s\n", &entry.proof[0]);
+            }
+            if(argc >= 3) writeResult(argv[2], entry.result, entry.model);
+            printf(entry.result == l_True ? "s SATISFIABLE\n" : "s UNSATISFIABLE\n");
+            exit(entry.result == l_True ? 10 : 20);
+        }
+
+        if(dimacs_out || (cached[0] != 0 && !from_cache)) {
+            S.simplify();
+            if(dimacs_out && !writeSimplified(S, dimacs_out))
+                printf("c WARNING! Could not write the simplified formula to %s\n", (const char *) dimacs_out);
+            if(cached[0] != 0 && !from_cache && !writeSimplified(S, cached, &id))
+                printf("c WARNING! Could not write the simplified formula to %s\n", cached);
+        }
 
         if(S.verbosity > 0) {
             printf("c Number of variables:  %12d                                         \n", S.nVars());
@@ -133,6 +446,31 @@ int main(int argc, char **argv) {
             printf("c                                                                             \n");
         }
 
+        // Per-instance configuration:
+        if(features || config_table) {
+            vec<double> f;
+            S.computeFeatures(f);
+            if(features)
+                for(int i = 0; i < f.size(); i++)
+                    printf("c feature %-16s %g\n", feature_names[i], f[i]);
+
+            if(config_table) {
+                ConfigTable table;
+                if(!table.load(config_table)) exit(1);
+                int config = table.select(f);
+                if(config >= 0) {
+                    table.apply(config);
+                    S.updateParameters();
+                }
+                if(S.verbosity > 0)
+                    printf("c Selected configuration: %s\nc\n", config >= 0 ? table.name(config) : "<none>");
+            }
+        }
+
+        // Free memory before reaching the hard limit (unless a soft limit is given):
+        if(S.mem_soft_limit == 0 && mem_lim != INT32_MAX)
+            S.mem_soft_limit = ((uint64_t) mem_lim << 20) / 4 * 3;
+
         // Change to signal-handlers that will only notify the solver and allow it to terminate
         // voluntarily:
         signal(SIGINT, SIGINT_interrupt);
@@ -146,6 +484,22 @@ int main(int argc, char **argv) {
             printf("\n");
         }
         printf(ret == l_True ? "s SATISFIABLE\n" : ret == l_False ? "s UNSATISFIABLE\n" : "s INDETERMINATE\n");
+        if(argc >= 3) writeResult(argv[2], ret, S.model);
+
+        if(results != NULL && ret != l_Undef) {
+            entry.result = ret;
+            S.model.copyTo(entry.model);
+            entry.proof.clear();
+            if(ret == l_False && proof_file) {
+                char *path = realpath(proof_file, NULL);
+                for(const char *p = path != NULL ? path : (const char *) proof_file; *p != 0; p++) entry.proof.push(*p);
+                free(path);
+            }
+            entry.proof.push(0);
+            entry.check = id.check;
+            if(!results->store(id.hash, entry))
+                printf("c WARNING! Could not write the result to %s\n", (const char *) result_cache);
+        }
 
 
         exit(ret == l_True ? 10 : ret == l_False ? 20 : 0);     // (faster than "return", which will invoke the destructor for 'Solver')
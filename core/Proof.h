@@ -0,0 +1,110 @@
+#ifndef Minisat_Proof_h
+#define Minisat_Proof_h
+
+#include <stdio.h>
+
+#include "mtl/IntTypes.h"
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// Proof -- writes a DRAT or LRAT refutation, in text or binary form:
+//
+// DRAT lines list the literals of added ('a') and deleted ('d') clauses. LRAT additions also give
+// the clause identifier and the hints: the identifiers of the clauses that become unit (the last
+// one falsified) under the negation of the added clause, in order. Deletions only give identifiers.
+//
+// In binary form, every number is written as a 7-bit variable-length integer, literals being
+// mapped to 2*(var+1)+sign and clause identifiers to 2*id.
+
+    class Proof {
+        FILE *out;
+        bool lrat_;
+        bool binary;
+        uint64_t last_id;            // Text LRAT deletion lines are labelled with the last added identifier.
+
+
+        void writeBinary(uint64_t x) {
+            while(x > 127) {
+                putc((int) ((x & 127) | 128), out);
+                x >>= 7;
+            }
+            putc((int) x, out);
+        }
+
+
+        void writeText(int64_t x) {
+            char buf[24];
+            int i = 0;
+            uint64_t u = x < 0 ? -(uint64_t) x : (uint64_t) x;
+            do buf[i++] = '0' + (char) (u % 10); while((u /= 10) > 0);
+            if(x < 0) putc('-', out);
+            while(i > 0) putc(buf[--i], out);
+            putc(' ', out);
+        }
+
+
+        void writeLit(Lit p) {
+            if(binary) writeBinary(2 * (uint64_t) (var(p) + 1) + sign(p));
+            else writeText(sign(p) ? -(var(p) + 1) : var(p) + 1);
+        }
+
+
+        void writeId(uint64_t id) {
+            if(binary) writeBinary(2 * id);
+            else writeText((int64_t) id);
+        }
+
+
+        void writeEnd() {
+            if(binary) putc(0, out);
+            else fputs("0", out);
+        }
+
+
+    public:
+        Proof(FILE *o, bool lrat, bool bin) : out(o), lrat_(lrat), binary(bin), last_id(0) {}
+
+
+        bool lrat() const { return lrat_; }
+
+
+        // Log the addition of a clause. The identifier and the hints are ignored for DRAT:
+        template<class Lits>
+        void add(uint64_t id, const Lits &lits, const vec<uint64_t> &hints) {
+            if(binary) putc('a', out);
+            if(lrat_) writeId(id), last_id = id;
+            for(int i = 0 ; i < lits.size() ; i++) writeLit(lits[i]);
+            writeEnd();
+            if(lrat_) {
+                if(!binary) putc(' ', out);
+                for(int i = 0 ; i < hints.size() ; i++) writeId(hints[i]);
+                writeEnd();
+            }
+            if(!binary) putc('\n', out);
+        }
+
+
+        // Log the deletion of a clause. LRAT only uses the identifier, DRAT only the literals:
+        template<class Lits>
+        void remove(uint64_t id, const Lits &lits) {
+            if(binary) putc('d', out);
+            else if(lrat_) writeText((int64_t) last_id), fputs("d ", out);
+            else fputs("d ", out);
+            if(lrat_) writeId(id);
+            else
+                for(int i = 0 ; i < lits.size() ; i++) writeLit(lits[i]);
+            writeEnd();
+            if(!binary) putc('\n', out);
+        }
+
+
+        void flush() { fflush(out); }
+    };
+
+//=================================================================================================
+}
+
+#endif
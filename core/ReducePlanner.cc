@@ -0,0 +1,110 @@
+#include "mtl/Sort.h"
+#include "core/ReducePlanner.h"
+
+using namespace CDCL;
+
+
+ReducePlanner::ReducePlanner() : epoch(0), started(false), state(idle), stopping(false), fraction(0.5) {
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&wake, NULL);
+}
+
+
+ReducePlanner::~ReducePlanner() {
+    if(started) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+        pthread_join(thread, NULL);
+    }
+    pthread_cond_destroy(&wake);
+    pthread_mutex_destroy(&lock);
+}
+
+
+void ReducePlanner::start(double f) {
+    pthread_mutex_lock(&lock);
+    assert(state == idle);
+    fraction = f;
+    state = planning;
+    if(!started) {
+        pthread_create(&thread, NULL, worker, this);
+        started = true;
+    }
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+
+bool ReducePlanner::busy() {
+    pthread_mutex_lock(&lock);
+    bool b = state == planning;
+    pthread_mutex_unlock(&lock);
+    return b;
+}
+
+
+bool ReducePlanner::ready() {
+    pthread_mutex_lock(&lock);
+    bool r = state == planned;
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+
+void ReducePlanner::taken() {
+    pthread_mutex_lock(&lock);
+    assert(state == planned);
+    state = idle;
+    pthread_mutex_unlock(&lock);
+}
+
+
+void *ReducePlanner::worker(void *planner) {
+    ((ReducePlanner *) planner)->run();
+    return NULL;
+}
+
+
+/**
+ * Make a plan each time one is started, until the planner is deleted. The search thread does not
+ * touch 'snapshot' and 'plan' while the state is 'planning'.
+ */
+
+void ReducePlanner::run() {
+    pthread_mutex_lock(&lock);
+    for(;;) {
+        while(state != planning && !stopping) pthread_cond_wait(&wake, &lock);
+        if(stopping) break;
+        pthread_mutex_unlock(&lock);
+        makePlan();
+        pthread_mutex_lock(&lock);
+        state = planned;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+
+// The order of 'reduceDB_lt' in 'Solver.cc': the binary clauses last, then by decreasing number of
+// communities spanned (all 0 unless 'comm_reduce' is set), then by decreasing LBD, then by increasing
+// activity:
+struct snapshot_lt {
+    bool operator()(const ReducePlanner::Learnt &x, const ReducePlanner::Learnt &y) const {
+        if(x.size > 2 && y.size == 2) return true;
+        if(x.size == 2) return false;
+        if(x.span != y.span) return x.span > y.span;
+        if(x.lbd != y.lbd) return x.lbd > y.lbd;
+        return x.activity < y.activity;
+    }
+};
+
+
+// 'plan' has room for the whole snapshot, so that the pushes do not allocate (see 'Solver::planReduceDB()'):
+void ReducePlanner::makePlan() {
+    sort(snapshot, snapshot_lt());
+    plan.clear();
+    int limit = (int) (snapshot.size() * fraction);
+    for(int i = 0; i < limit; i++)
+        if(snapshot[i].size > 2) plan.push(snapshot[i].cr);
+}
@@ -0,0 +1,61 @@
+#ifndef Minisat_ReducePlanner_h
+#define Minisat_ReducePlanner_h
+
+#include <pthread.h>
+
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// ReducePlanner -- the reduction of the learnt clauses, planned by a helper thread:
+//
+// The search thread copies what a reduction looks at (the size, LBD and activity of each learnt
+// clause) to 'snapshot', and calls 'start()'. While the search goes on, the helper thread sorts the
+// copy as 'Solver::reduceDB()' sorts the clauses, and puts the clauses to remove in 'plan'. Once the
+// plan is 'ready()', the search thread applies it (see 'Solver::applyReducePlan()'): its clause
+// references are still valid if no garbage collection happened since the snapshot.
+
+    class ReducePlanner {
+    public:
+        struct Learnt {
+            CRef cr;
+            uint32_t size;
+            uint32_t span;           // The communities spanned (0 if not ranked by them, see 'Solver::comm_reduce').
+            uint32_t lbd;
+            float activity;
+        };
+
+        vec<Learnt> snapshot;        // The learnt clauses, filled before 'start()'.
+        vec<CRef> plan;              // The clauses to remove, when the plan is ready.
+        uint64_t epoch;              // The garbage collections made before the snapshot (set by the caller).
+
+        ReducePlanner();
+        ~ReducePlanner();            // Waits for the plan in progress, and joins the thread.
+
+        void start(double fraction); // Plan the removal of this part of the snapshot, binary clauses excepted.
+        bool busy();                 // TRUE from 'start()' until the plan is ready.
+        bool ready();                // TRUE if a plan is ready and was not taken yet.
+        void taken();                // The plan was applied or dropped.
+
+    private:
+        enum State { idle, planning, planned };
+
+        pthread_t thread;
+        bool started;                // The thread is created by the first 'start()'.
+        pthread_mutex_t lock;
+        pthread_cond_t wake;
+        State state;
+        bool stopping;
+        double fraction;
+
+        static void *worker(void *planner);
+        void run();
+        void makePlan();
+    };
+
+//=================================================================================================
+}
+
+#endif
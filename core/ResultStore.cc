@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "utils/ParseUtils.h"
+#include "core/ResultStore.h"
+
+using namespace CDCL;
+
+
+DirectoryStore::DirectoryStore(const char *d) : dir(strdup(d)) {}
+
+
+DirectoryStore::~DirectoryStore() { free(dir); }
+
+
+void DirectoryStore::path(uint64_t key, char *buf, int size) const {
+    snprintf(buf, size, "%s/%016" PRIx64 ".res", dir, key);
+}
+
+
+/**
+ * Read the entry of a formula.
+ * @param key the hash of the formula
+ * @param e the entry, valid if true is returned
+ * @return false if there is no entry, or if it can not be read
+ */
+
+bool DirectoryStore::lookup(uint64_t key, Entry &e) {
+    char file[4096];
+    path(key, file, sizeof(file));
+    gzFile f = gzopen(file, "rb");
+    if(f == NULL) return false;
+
+    StreamBuffer in(f);
+    bool ok = true;
+    e.model.clear();
+    e.proof.clear();
+    e.check = 0;
+    skipWhitespace(in);
+    if(*in == 'h') {
+        ++in;
+        e.check = parseHex(in);
+        skipWhitespace(in);
+    }
+    if(eagerMatch(in, "s SATISFIABLE")) {
+        e.result = l_True;
+        for(;;) {
+            skipWhitespace(in);
+            if(*in == EOF) break;
+            if(*in == 'v') {
+                ++in;
+                continue;
+            }
+            int lit = parseInt(in);
+            if(lit == 0) break;
+            int v = abs(lit) - 1;
+            e.model.growTo(v + 1, l_Undef);
+            e.model[v] = lbool(lit > 0);
+        }
+    } else if(eagerMatch(in, "UNSATISFIABLE")) {   // (the 's ' was matched by the first test)
+        e.result = l_False;
+        skipWhitespace(in);
+        if(*in == 'p') {
+            ++in;
+            skipWhitespace(in);
+            while(*in != EOF && *in != '\n') e.proof.push((char) *in), ++in;
+        }
+        e.proof.push(0);
+    } else
+        ok = false;
+    gzclose(f);
+    return ok;
+}
+
+
+/**
+ * Write the entry of a formula. It is written to a temporary file first, then renamed, so that
+ * concurrent readers never see a partial entry.
+ * @param key the hash of the formula
+ * @param e the entry
+ * @return false if it could not be written
+ */
+
+bool DirectoryStore::store(uint64_t key, const Entry &e) {
+    char file[4096], tmp[4096];
+    path(key, file, sizeof(file));
+    snprintf(tmp, sizeof(tmp), "%s.tmp%d", file, (int) getpid());
+    FILE *out = fopen(tmp, "wb");
+    if(out == NULL) return false;
+
+    fprintf(out, "h %016" PRIx64 "\n", e.check);
+    if(e.result == l_True) {
+        fprintf(out, "s SATISFIABLE\nv");
+        for(int i = 0; i < e.model.size(); i++)
+            if(e.model[i] != l_Undef) fprintf(out, " %s%d", e.model[i] == l_True ? "" : "-", i + 1);
+        fprintf(out, " 0\n");
+    } else {
+        fprintf(out, "s UNSATISFIABLE\n");
+        if(e.proof.size() > 1) fprintf(out, "p %s\n", &e.proof[0]);
+    }
+
+    if(fclose(out) == 0 && rename(tmp, file) == 0) return true;
+    ::remove(tmp);
+    return false;
+}
@@ -0,0 +1,112 @@
+#ifndef Minisat_ResultStore_h
+#define Minisat_ResultStore_h
+
+#include "mtl/Vec.h"
+#include "mtl/Sort.h"
+#include "core/SolverTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// ResultStore -- maps the hash of a formula (see 'FormulaHash') to its result:
+//
+// Only definite results are stored: a model for a satisfiable formula, and for an unsatisfiable
+// one the file where its refutation was written, if any. An entry also holds a second hash of the
+// formula ('FormulaHash::check()'), compared before an unsatisfiable result is trusted: unlike a
+// model, it can not be checked against the formula. 'DirectoryStore' is a local store, other
+// ones (e.g. shared between machines) only have to implement 'lookup()' and 'store()'.
+
+    class ResultStore {
+    public:
+        struct Entry {
+            lbool result;            // 'l_True' or 'l_False'.
+            vec<lbool> model;        // If satisfiable: the value of each variable.
+            vec<char> proof;         // If unsatisfiable: the (NUL-terminated) path of a refutation, empty if none.
+            uint64_t check;          // The second hash of the formula (0 if unknown).
+        };
+
+        virtual ~ResultStore() {}
+
+        virtual bool lookup(uint64_t key, Entry &e) = 0;        // FALSE if the formula is not known.
+        virtual bool store(uint64_t key, const Entry &e) = 0;   // FALSE if the entry could not be written.
+    };
+
+
+//=================================================================================================
+// DirectoryStore -- one text file per formula, named after its hash:
+//
+//   h <check>                           h <check>
+//   s SATISFIABLE                       s UNSATISFIABLE
+//   v 1 -2 3 ... 0                      p <proof file>     (optional)
+
+    class DirectoryStore : public ResultStore {
+        char *dir;
+
+        void path(uint64_t key, char *buf, int size) const;
+
+    public:
+        explicit DirectoryStore(const char *d);
+        ~DirectoryStore();
+
+        bool lookup(uint64_t key, Entry &e);
+        bool store(uint64_t key, const Entry &e);
+    };
+
+
+//=================================================================================================
+// FormulaHash -- passes the clauses of a parser on to a solver, and hashes them:
+//
+// The hash does not depend on the order of the clauses, nor on the order or repetition of the
+// literals in a clause. 'check()' is a second hash of the same kind, from independent constants.
+
+    template<class Solver>
+    class FormulaHash {
+        Solver &S;
+        uint64_t sum, mixed;
+        uint64_t sum2, mixed2;
+        int nclauses;
+        vec<Lit> tmp;
+
+        static uint64_t mix(uint64_t x) {
+            x ^= x >> 33, x *= 0xFF51AFD7ED558CCDULL;
+            x ^= x >> 33, x *= 0xC4CEB9FE1A85EC53ULL;
+            return x ^ (x >> 33);
+        }
+
+        static uint64_t mix2(uint64_t x) {
+            x ^= x >> 30, x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27, x *= 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+
+    public:
+        explicit FormulaHash(Solver &s) : S(s), sum(0), mixed(0), sum2(0), mixed2(0), nclauses(0) {}
+
+        // Interface of the DIMACS parser:
+        int nVars() const { return S.nVars(); }
+        Var newVar() { return S.newVar(); }
+        bool addClause_(vec<Lit> &ps) {
+            ps.copyTo(tmp);
+            sort(tmp);
+            uint64_t h = 0x9E3779B97F4A7C15ULL, h2 = 0x2545F4914F6CDD1DULL;
+            for(int i = 0; i < tmp.size(); i++)
+                if(i == 0 || tmp[i] != tmp[i - 1]) {
+                    h = mix(h ^ (uint64_t) toInt(tmp[i]));
+                    h2 = mix2(h2 + (uint64_t) toInt(tmp[i]));
+                }
+            sum += h;
+            mixed ^= mix(h);
+            sum2 += h2;
+            mixed2 ^= mix2(h2);
+            nclauses++;
+            return S.addClause_(ps);
+        }
+
+        uint64_t hash() const { return mix(sum ^ mix(mixed) ^ mix((uint64_t) S.nVars() << 32 | (uint32_t) nclauses)); }
+        uint64_t check() const { return mix2(sum2 ^ mix2(mixed2) ^ mix2((uint64_t) nclauses << 32 | (uint32_t) S.nVars())); }
+    };
+
+//=================================================================================================
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "mtl/Sort.h"
 #include "core/Solver.h"
+#include "core/ReducePlanner.h"
 
 using namespace CDCL;
 
@@ -13,37 +14,51 @@ using namespace CDCL;
 //=================================================================================================
 
 /**
- * Search for a model the specified number of conflicts.
+ * Search for a model the specified number of conflicts (the run then ends with a restart). The search
+ * also returns, without backtracking, when 'yield_conflicts' is reached: 'in_run' is then still TRUE.
  * @param nof_conflicts
  * @return l_True id a solution is found. l_False if the formula is UNSAT, l_Undef otherwise.
  */
 
-lbool Solver::search(int nof_conflicts) {
+lbool Solver::search(int nof_conflicts) { return (this->*search_fn)(nof_conflicts); }
+
+
+template<class P>
+lbool Solver::search_(int nof_conflicts) {
     assert(ok);
     int backtrack_level, lbd;
-    int nbConflictsInCurrentRun = 0;
     vec<Lit> learnt_clause;
 
     for(;;) {
-        CRef confl = propagate();                                // BCP (propagate all unit clauses until a fix point or a conflict is reached
+        CRef confl = propagate_<P>();                            // BCP (propagate all unit clauses until a fix point or a conflict is reached
 
         if(confl != CRef_Undef) {  // CONFLICT
-            conflicts++;nbConflictsInCurrentRun++;
+            conflicts++;run_conflicts++;
 
-            if(decisionLevel() == 0) return l_False;             // Formula is UNSAT
+            if(decisionLevel() == 0) {                           // Formula is UNSAT
+                logEmptyClause(confl);
+                return l_False;
+            }
 
-            analyze(confl, learnt_clause, backtrack_level, lbd); // Analyze
+            analyze<P>(confl, learnt_clause, backtrack_level, lbd); // Analyze
+            sum_inv_lbd += 1.0 / lbd;
             cancelUntil(backtrack_level);                        // Backjump
 
-            if(learnt_clause.size() == 1)
+            uint64_t id = ++next_clause_id;
+            if(P::proof) proof->add(id, learnt_clause, lrat_hints);
+
+            if(learnt_clause.size() == 1) {
                 uncheckedEnqueue(learnt_clause[0]);              // Unary clause is learnt, assign the literal at decision level 0
-            else {
+                if(P::lrat) unit_id[var(learnt_clause[0])] = id;
+            } else {
                 CRef cr = ca.alloc(learnt_clause, true);         // Create a new clause
+                if(ca.clause_ids) ca[cr].id(id);
                 learnts.push(cr);                                // Add it in the learnt clauses database
                 attachClause(cr);                                // Attach it
                 claBumpActivity(ca[cr]);                         // Bump its activity
                 uncheckedEnqueue(learnt_clause[0], cr);          // Assign the asserting literal, its reason is the asserting clause
                 ca[cr].lbd(lbd);
+                if(P::instrumented && track_learnts && ca[cr].has_id()) learnt_lifetimes.learnt(id, conflicts, lbd, learnt_clause.size());
             }
 
             varDecayActivity();                                  // Decay the activity of all variables
@@ -52,19 +67,55 @@ lbool Solver::search(int nof_conflicts) {
             if(conflicts % 1000 == 0 && verbosity >= 1) printIntermediateStats();
 
         } else {  // NO CONFLICT
-            if(nof_conflicts >= 0 && nbConflictsInCurrentRun >= nof_conflicts || !withinBudget()) { // Reached bound on number of conflicts.
+            if(nof_conflicts >= 0 && run_conflicts >= nof_conflicts || !withinBudget()) { // Reached bound on number of conflicts.
                 cancelUntil(0);
+                in_run = false;
+                return l_Undef;
+            }
+
+            if(conflicts >= yield_conflicts)        // Yield, the run goes on at the next call
                 return l_Undef;
+
+            if(decisionLevel() == 0 && !simplify()) // New level-0 assignments: simplify the clauses
+                return l_False;
+
+            if(inprocess && decisionLevel() == 0 && conflicts >= next_inprocess) { // Simplify the binary clauses
+                if(!inprocessBinaries<P>()) return l_False;
+                next_inprocess = conflicts + inprocess_interval;
             }
 
             if(conflicts >= nextReduceDB) { // It is time to reduce the learnt clauses database
-                reduceDB();
+                if(bg_reduce) planReduceDB();
+                else reduceDB();
                 nextReduceDB = conflicts + 2000 + 1000 * nb_reducedb;
             }
 
-            Lit next = pickBranchLit();            // New decision literal
+            if(mem_soft_limit > 0 && conflicts >= next_mem_check) { // Stay under the soft memory limit
+                next_mem_check = conflicts + 1000;
+                if(memoryFootprint() > mem_soft_limit + mem_margin) reduceMemory();
+            }
+
+            Lit next = lit_Undef;
+            while(decisionLevel() < assumptions.size()) {
+                // Perform user provided assumption:
+                Lit p = assumptions[decisionLevel()];
+                if(value(p) == l_True) {
+                    // Dummy decision level:
+                    newDecisionLevel();
+                } else if(value(p) == l_False) {
+                    analyzeFinal(~p, conflict);
+                    return l_False;
+                } else {
+                    next = p;
+                    break;
+                }
+            }
+
+            if(next == lit_Undef) {
+                next = pickBranchLit();            // New decision literal
 
-            if(next == lit_Undef) return l_True;   // No more literal to assign: model found
+                if(next == lit_Undef) return l_True;   // No more literal to assign: model found
+            }
 
             newDecisionLevel();                    // Increase decision level and enqueue 'next'
             uncheckedEnqueue(next);                // A decision literal, it has no reason
@@ -79,8 +130,43 @@ lbool Solver::search(int nof_conflicts) {
  */
 
 lbool Solver::solve_() {
+    startSolve();
+    lbool status;
+    do status = solveSteps(-1);
+    while(solving);
+    return status;
+}
+
+
+/**
+ * Start a search which is then run by 'solveSteps()', under the assumptions in 'assumptions'.
+ */
+
+void Solver::startSolve() {
     model.clear();
-    if(!ok) return l_False;
+    conflict.clear();
+    dedup.clear();                                       // Only useful while adding clauses
+    dedup_valid = false;
+    solving = true;
+    in_run = false;
+    curr_restarts = 0;
+    if(!ok) {
+        if(empty_reason != CRef_Undef) {                 // Falsified while adding clauses, see 'addClause_()'
+            logEmptyClause(empty_reason);
+            empty_reason = CRef_Undef;
+        }
+        solve_status = l_False, solving = false;
+        return;
+    }
+    if(!simplify()) {
+        solve_status = l_False, solving = false;
+        return;
+    }
+    if(occ_init && conflicts == 0) initActivities();
+    else if(heap_pending) buildOrderHeap();             // ('occ_init' was unset after the variables were added)
+    if((comm_branch || comm_reduce) && community.size() == 0) computeCommunities();
+    if(track_learnts) ca.clause_ids = true;             // (the history of a learnt clause is found by its identifier)
+    selectSearch();
 
     if(verbosity >= 1) {
         printf("c ");
@@ -95,13 +181,71 @@ lbool Solver::solve_() {
         std::cout << std::endl;
     }
 
-    lbool status = l_Undef;
+    if(bandit && arms.size() == 0) {   // Two decay factors, with short and long runs
+        static const double decays[] = {0.95, 0.85};
+        static const int units[] = {32, 128};
+        for(int i = 0; i < 4; i++) {
+            BanditArm a = {decays[i / 2], units[i % 2], 0, 0};
+            arms.push(a);
+        }
+    }
+}
+
+
+/**
+ * Choose the instantiation of 'search_()' for the proof output and the instrumentation options
+ * (tested once here instead of in the propagation and conflict analysis loops).
+ */
+
+void Solver::selectSearch() {
+    bool instrumented = prop_stats || track_learnts;
+    if(proof == NULL)
+        search_fn = instrumented ? &Solver::search_<SearchPolicy<false, false, true> >
+                                 : &Solver::search_<SearchPolicy<false, false, false> >;
+    else if(!lrat)
+        search_fn = instrumented ? &Solver::search_<SearchPolicy<true, false, true> >
+                                 : &Solver::search_<SearchPolicy<true, false, false> >;
+    else
+        search_fn = instrumented ? &Solver::search_<SearchPolicy<true, true, true> >
+                                 : &Solver::search_<SearchPolicy<true, true, false> >;
+}
 
-    int curr_restarts = 0;
+
+/**
+ * Go on with the search started by 'startSolve()' (or 'beginSolve()') for about 'max_conflicts'
+ * conflicts. The search then yields, keeping its state (trail included), and the next call resumes it.
+ * @param max_conflicts the conflicts before yielding, -1 to run until the search is over
+ * @return the result if the search is over ('solving' is then FALSE), l_Undef otherwise
+ */
+
+lbool Solver::solveSteps(int64_t max_conflicts) {
+    if(!solving) return solve_status;
+    yield_conflicts = max_conflicts < 0 ? UINT64_MAX : conflicts + max_conflicts;
+
+    lbool status = l_Undef;
     while(status == l_Undef) {
-        starts++;
-        double rest_base = luby_restart ? luby(2, curr_restarts) : pow(1.5, curr_restarts);
-        status = search(rest_base * 32);  // Search for a limited number of conflict
+        if(!in_run) {                         // Start a new run
+            if(planner != NULL && planner->ready()) applyReducePlan();
+            starts++;
+            run_arm = bandit ? selectArm() : -1;
+            int k = run_arm >= 0 ? arms[run_arm].pulls : curr_restarts;   // (each arm follows its own restart sequence)
+            double rest_base = luby_restart ? luby(2, k) : pow(1.5, k);
+            if(run_arm >= 0) var_decay = arms[run_arm].var_decay;
+            run_limit = (int) (rest_base * (run_arm >= 0 ? arms[run_arm].restart_unit : 32));
+            run_conflicts = 0;
+            run_conflicts_before = conflicts;
+            run_inv_lbd_before = sum_inv_lbd;
+            in_run = true;
+        }
+        try {
+            status = search(run_limit);       // Search for a limited number of conflict
+        } catch(OutOfMemoryException &) {     // Go on with fewer learnt clauses (fails again if that is not enough)
+            recoverMemory();
+            in_run = false;
+        }
+        if(in_run && status == l_Undef) return l_Undef;   // Yield
+        in_run = false;
+        if(run_arm >= 0) rewardArm(run_arm, conflicts - run_conflicts_before, sum_inv_lbd - run_inv_lbd_before);
         if(!withinBudget()) break;
         curr_restarts++;
     }
@@ -109,58 +253,216 @@ lbool Solver::solve_() {
     if(status == l_True) {
         model.growTo(nVars()); // Extend & copy model:
         for(int i = 0; i < nVars(); i++) model[i] = value(i);
-    }
+    } else if(status == l_False && conflict.size() == 0)
+        ok = false;            // Unsatisfiable without the assumptions
 
     cancelUntil(0);
+    solve_status = status, solving = false;
     return status;
 }
 
 
+/**
+ * Choose the arm of the next run with UCB1: each arm is tried once, then the one with the highest
+ * mean reward plus 'bandit_explore' * sqrt(2 ln(runs) / runs of the arm) is used.
+ * @return the index of the arm in 'arms'
+ */
+
+int Solver::selectArm() {
+    int total = 0;
+    for(int i = 0; i < arms.size(); i++) {
+        if(arms[i].pulls == 0) return i;
+        total += arms[i].pulls;
+    }
+
+    int best = 0;
+    double best_score = -1;
+    for(int i = 0; i < arms.size(); i++) {
+        double score = arms[i].reward + bandit_explore * sqrt(2 * log((double) total) / arms[i].pulls);
+        if(score > best_score) best = i, best_score = score;
+    }
+    return best;
+}
+
+
+/**
+ * Reward an arm by the quality of the clauses learnt during its run: the mean of 1/LBD, between 0 and 1.
+ * The mean reward of the arm weights recent runs more, as the best heuristics change during the search.
+ * @param arm
+ * @param nof_conflicts the conflicts of the run
+ * @param inv_lbd the sum of 1/LBD over the clauses learnt in the run
+ */
+
+void Solver::rewardArm(int arm, uint64_t nof_conflicts, double inv_lbd) {
+    BanditArm &a = arms[arm];
+    double r = nof_conflicts == 0 ? 0 : inv_lbd / nof_conflicts;
+    a.pulls++;
+    a.reward += (r - a.reward) / (a.pulls < 10 ? a.pulls : 10);
+}
+
+
 //=================================================================================================
 // Heuristic, enqueue, propagation and backtrack
 //=================================================================================================
 
 
 /**
- * Select the next literal not assigned with the highest activity
+ * Select the next literal not assigned with the highest activity (or, with frequency 'random_var_freq',
+ * a random variable from the heap)
  * @return lit_Undef if none exist
  */
 
 Lit Solver::pickBranchLit() {
     Var next = var_Undef;
 
+    // Random decision:
+    if(random_var_freq > 0 && drand(random_seed) < random_var_freq && !order_heap.empty()) {
+        next = order_heap[irand(random_seed, order_heap.size())];
+        if(value(next) == l_Undef)
+            rnd_decisions++;
+    }
+
     while(next == var_Undef || value(next) != l_Undef)
         if(order_heap.empty())
             return lit_Undef;
+        else if(comm_branch)
+            next = pickInCommunity();
         else
             next = order_heap.removeMin();
+    if(comm_branch) curr_community = communityOf(next);
     decisions++;
     return mkLit(next, polarity[next]);
 }
 
 
+/**
+ * Select the decision variable of 'comm_branch': the variable of highest activity, unless a variable
+ * of the community of the last decision has at least 'comm_ratio' times its activity. Only the first
+ * entries of the heap are looked at: they are not sorted, but they are the closest to its top.
+ * @return the variable, removed from the heap (it may be assigned if it was the top of the heap)
+ */
+
+Var Solver::pickInCommunity() {
+    static const int window = 32;
+    Var next = order_heap[0];
+    if(curr_community >= 0 && communityOf(next) != curr_community && value(next) == l_Undef) {
+        double min_activity = activity[next] * comm_ratio;
+        int n = order_heap.size() < window ? order_heap.size() : window;
+        for(int i = 1; i < n; i++) {
+            Var v = order_heap[i];
+            if(communityOf(v) == curr_community && value(v) == l_Undef && activity[v] >= min_activity)
+                next = v, min_activity = activity[v];
+        }
+    }
+    order_heap.remove(next);
+    return next;
+}
+
+
+/**
+ * Initialize the activities and polarities with the Jeroslow-Wang weights of the literals: each clause
+ * of size n adds 2^-n to the weight of its literals. The activity of a variable is the sum of the
+ * weights of its two literals (scaled below one bump), its polarity the one of the heavier literal.
+ * The heap is then built at once.
+ */
+
+void Solver::initActivities() {
+    vec<double> weight(2 * nVars(), 0);
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        double w = ldexp(1, -(c.size() < 64 ? c.size() : 64));
+        for(int j = 0; j < c.size(); j++) weight[toInt(c[j])] += w;
+    }
+
+    double max = 0;
+    for(Var v = 0; v < nVars(); v++) {
+        double w = weight[toInt(mkLit(v))] + weight[toInt(~mkLit(v))];
+        if(w > max) max = w;
+    }
+    for(Var v = 0; v < nVars(); v++) {
+        Lit p = mkLit(v);
+        if(max > 0) activity[v] = (weight[toInt(p)] + weight[toInt(~p)]) / max * var_inc;
+        polarity[v] = weight[toInt(~p)] > weight[toInt(p)];
+    }
+    buildOrderHeap();
+}
+
+
+/**
+ * Build the heap at once from the unassigned variables (instead of inserting them one by one).
+ */
+
+void Solver::buildOrderHeap() {
+    vec<Var> vs;
+    for(Var v = 0; v < nVars(); v++)
+        if(value(v) == l_Undef) vs.push(v);
+    order_heap.build(vs);
+    heap_pending = false;
+}
+
+
 /**
  *    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
  *    otherwise CRef_Undef.
  *
  *    Post-conditions: the propagation queue is empty, even if there was a conflict.
+ *
+ *    The binary clauses of all the enqueued facts are propagated first ('bin_qhead' runs ahead of
+ *    'qhead'), so that the implications and conflicts they give are found before any longer clause
+ *    is visited.
  * @return CRef_Undef or a clause reference
  */
 
 CRef Solver::propagate() {
+    if(prop_stats || track_learnts) return propagate_<SearchPolicy<false, false, true> >();
+    return propagate_<SearchPolicy<false, false, false> >();
+}
+
+
+template<class P>
+CRef Solver::propagate_() {
+    const bool stats = P::instrumented;
     CRef confl = CRef_Undef;
     watches.cleanAll();
+    watches_bin.cleanAll();
 
     while(qhead < trail.size()) {
+        while(bin_qhead < trail.size()) {    // The binary clauses first
+            Lit p = trail[bin_qhead++];
+            const vec<Watcher> &bs = watches_bin[p];
+            for(int k = 0; k < bs.size(); k++) {
+                Lit imp = bs[k].blocker;     // (the other literal of the clause)
+                if(stats) propagation_stats.bin_watchers++;
+                if(value(imp) == l_True) {
+                    if(stats) propagation_stats.bin_true++;
+                    continue;
+                }
+                if(value(imp) == l_False) {
+                    confl = bs[k].cref;
+                    qhead = bin_qhead = trail.size();
+                    return confl;
+                }
+                uncheckedEnqueue(imp, bs[k].cref);   // (its reason may have 'imp' second, see 'locked()')
+                if(stats && track_learnts) {
+                    const Clause &c = ca[bs[k].cref];
+                    LearntLifetimes::Record *r;
+                    if(c.learnt() && c.has_id() && (r = learnt_lifetimes.record(c.id())) != NULL) r->propagations++;
+                }
+            }
+        }
+
         Lit p = trail[qhead++];          // 'p' is enqueued fact to propagate.
         vec<Watcher> &ws = watches[p];   // The clauses watched by p
         Watcher *i, *j, *end;
         propagations++;
+        if(stats) propagation_stats.watch_lists.add(ws.size());
 
         for(i = j = (Watcher *) ws, end = i + ws.size(); i != end;) {
 
             Lit blocker = i->blocker;
+            if(stats) propagation_stats.watchers++;
             if(value(blocker) == l_True) { // Try to avoid inspecting the clause
+                if(stats) propagation_stats.blocker_hits++;
                 *j++ = *i++;               // The current clause is always watched by p
                 continue;
             }
@@ -173,11 +475,13 @@ CRef Solver::propagate() {
                 c[0] = c[1], c[1] = false_lit;
             assert(c[1] == false_lit);
             i++;
+            if(stats) propagation_stats.clause_sizes.add(c.size());
 
             // If 0th watch is true, then clause is already satisfied.
             Lit first = c[0];
             Watcher w = Watcher(cr, first);
             if(first != blocker && value(first) == l_True) {
+                if(stats) propagation_stats.first_hits++;
                 *j++ = w;
                 continue;
             }
@@ -185,22 +489,28 @@ CRef Solver::propagate() {
             // Look for new watch
             for(int k = 2; k < c.size(); k++)
                 if(value(c[k]) != l_False) {  // A new watcher for this clause: c[k]
+                    if(stats) propagation_stats.replacements.add(k - 1);
                     c[1] = c[k];              // Invert c[k] and c[1] (invariant...)
                     c[k] = false_lit;
                     watches[~c[1]].push(w);
                     goto NextClause;
                 }
+            if(stats) propagation_stats.replacements.add(c.size() - 2);
 
             // Did not find watch -- clause is unit under assignment:
             *j++ = w;
             if(value(first) == l_False) { // The first watch is false, a conflict occurs
                 confl = cr;               // With this clause
-                qhead = trail.size();     // Do not forget to put qhead at the end
+                qhead = bin_qhead = trail.size();   // Do not forget to put qhead at the end
                 // Copy the remaining watches:
                 while(i < end)
                     *j++ = *i++;
-            } else
+            } else {
                 uncheckedEnqueue(first, cr);
+                LearntLifetimes::Record *r;
+                if(stats && track_learnts && c.learnt() && c.has_id() && (r = learnt_lifetimes.record(c.id())) != NULL)
+                    r->propagations++;
+            }
 
             NextClause:;
         }
@@ -237,7 +547,7 @@ void Solver::cancelUntil(int level) {
             polarity[x] = sign(trail[c]);                              // Save its polarity
             insertVarOrder(x);                                         // Insert it in the heap
         }
-        qhead = trail_lim[level];                                      // Set the head of the queue
+        qhead = bin_qhead = trail_lim[level];                          // Set the heads of the queue
         trail.shrink(trail.size() - trail_lim[level]);                 // Remove all propagations
         trail_lim.shrink(trail_lim.size() - level);                    // Reduce the trail_lim
         assert(trail_lim.size() == level);
@@ -255,10 +565,12 @@ void Solver::cancelUntil(int level) {
  * @param out_btlevel the backtrack level
  */
 
+template<class P>
 void Solver::analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int &lbd) {
     int nbResolutionsToPerform = 0;
 
     out_learnt.clear();
+    if(P::lrat) lrat_units.clear(), lrat_chain.clear();
     Lit p = lit_Undef;
 
     // Generate conflict clause:
@@ -268,8 +580,15 @@ void Solver::analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int &lb
     do {
         assert(confl != CRef_Undef);                   // (otherwise should be UIP)
         Clause &c = ca[confl];
+        if(p != lit_Undef) impliedFirst(c);
         nb_resolutions++;
         if(c.learnt()) claBumpActivity(c);             // The clause is useful
+        LearntLifetimes::Record *r;
+        if(P::instrumented && track_learnts && c.learnt() && c.has_id() && (r = learnt_lifetimes.record(c.id())) != NULL) {
+            r->uses++;
+            r->lbd = computeLBD(c);                    // (all its literals are assigned)
+        }
+        if(P::lrat) lrat_chain.push(c.id());           // The resolution chain, in reverse order
 
         for(int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++) {
             Lit q = c[j];
@@ -281,6 +600,10 @@ void Solver::analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int &lb
                     nbResolutionsToPerform++;          // one more literal to remove
                 else
                     out_learnt.push(q);                // The literal was assigned before, add it to the asserting clause
+            } else if(P::lrat && !seen[var(q)] && level(var(q)) == 0) {
+                seen[var(q)] = 1;                      // LRAT: the unit clauses of level-0 literals are hints too
+                analyze_toclear.push(q);
+                lrat_units.push(unitId(var(q)));
             }
         }
 
@@ -313,6 +636,52 @@ void Solver::analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int &lb
 
     lbd = computeLBD(out_learnt);
     for(int j = 0; j < out_learnt.size(); j++) seen[var(out_learnt[j])] = 0;    // ('seen[]' is now cleared)
+
+    if(P::lrat) {  // Hints: the units first, then the chain in trail order, the conflict last
+        lrat_units.copyTo(lrat_hints);
+        for(int i = lrat_chain.size() - 1; i >= 0; i--) lrat_hints.push(lrat_chain[i]);
+        for(int i = 0; i < analyze_toclear.size(); i++) seen[var(analyze_toclear[i])] = 0;
+        analyze_toclear.clear();
+    }
+}
+
+
+
+/**
+ * Specialized analysis procedure to express the final conflict in terms of assumptions.
+ * Calculates the (possibly empty) set of assumptions that led to the assignment of 'p', and
+ * stores the result in 'out_conflict'.
+ * @param p the negation of a failed assumption
+ * @param out_conflict the assumptions responsible, negated ('p' first)
+ */
+
+void Solver::analyzeFinal(Lit p, vec<Lit> &out_conflict) {
+    out_conflict.clear();
+    out_conflict.push(p);
+
+    if(decisionLevel() == 0)
+        return;
+
+    seen[var(p)] = 1;
+
+    for(int i = trail.size() - 1; i >= trail_lim[0]; i--) {
+        Var x = var(trail[i]);
+        if(seen[x]) {
+            if(reason(x) == CRef_Undef) {
+                assert(level(x) > 0);
+                out_conflict.push(~trail[i]);
+            } else {
+                Clause &c = ca[reason(x)];
+                impliedFirst(c);
+                for(int j = 1; j < c.size(); j++)
+                    if(level(var(c[j])) > 0)
+                        seen[var(c[j])] = 1;
+            }
+            seen[x] = 0;
+        }
+    }
+
+    seen[var(p)] = 0;
 }
 
 
@@ -346,19 +715,74 @@ struct reduceDB_lt {
 };
 
 
+// The order of 'comm_reduce': the number of communities spanned by a clause comes before its LBD.
+struct SpanKey {
+    CRef cr;
+    int span;
+};
+
+struct reduceDB_span_lt {
+    ClauseAllocator &ca;
+
+    reduceDB_span_lt(ClauseAllocator &ca_) : ca(ca_) {}
+
+    bool operator()(const SpanKey &x, const SpanKey &y) {
+        if(x.span != y.span) return x.span > y.span;
+        return reduceDB_lt(ca)(x.cr, y.cr);
+    }
+};
+
+
+/**
+ * Count the communities of the variables of a clause, each variable without a community counting
+ * as one (see 'computeCommunities()').
+ * @param c
+ * @return the number of communities
+ */
+
+int Solver::communitySpan(const Clause &c) {
+    if(comm_stamp.size() < nb_communities) comm_stamp.growTo(nb_communities, 0);
+    if(++comm_stamp_counter == 0) {                 // (wrapped around)
+        for(int i = 0; i < comm_stamp.size(); i++) comm_stamp[i] = 0;
+        comm_stamp_counter = 1;
+    }
+    int span = 0;
+    for(int i = 0; i < c.size(); i++) {
+        int k = communityOf(var(c[i]));
+        if(k < 0 || k >= comm_stamp.size()) span++;
+        else if(comm_stamp[k] != comm_stamp_counter) comm_stamp[k] = comm_stamp_counter, span++;
+    }
+    return span;
+}
+
+
 /**
- * Remove half of the learnt clauses, minus the clauses locked by the current assignment.
+ * Remove a part (by default half) of the learnt clauses, minus the clauses locked by the current assignment.
+ * With 'comm_reduce', the clauses spanning the most communities are removed first.
+ * @param fraction the part of the (sorted) learnt clauses to consider for removal
  */
 
-void Solver::reduceDB() {
+void Solver::reduceDB(double fraction) {
     int i, j;
     nb_reducedb++;
-    sort(learnts, reduceDB_lt(ca));
+    if(dedup_learnts) removeDuplicates(learnts, nb_duplicate_learnts);
+    if(comm_reduce && nb_communities > 0) {
+        vec<SpanKey> keys(learnts.size());
+        for(i = 0; i < learnts.size(); i++) {
+            Clause &c = ca[learnts[i]];
+            keys[i].cr = learnts[i];
+            keys[i].span = c.size() == 2 ? 0 : communitySpan(c);   // (the binary clauses are kept anyway)
+        }
+        sort(keys, reduceDB_span_lt(ca));
+        for(i = 0; i < learnts.size(); i++) learnts[i] = keys[i].cr;
+    } else
+        sort(learnts, reduceDB_lt(ca));
 
-    // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
+    // Don't delete binary or locked clauses. From the rest, delete clauses from the first part
+    int limit = (int) (learnts.size() * fraction);
     for(i = j = 0; i < learnts.size(); i++) {
         Clause &c = ca[learnts[i]];
-        if(c.size() > 2 && !locked(c) && i < learnts.size() / 2)
+        if(c.size() > 2 && !locked(c) && i < limit)
             removeClause(learnts[i]);
         else
             learnts[j++] = learnts[i];
@@ -368,27 +792,657 @@ void Solver::reduceDB() {
 }
 
 
+/**
+ * Snapshot the learnt clauses for 'planner', which chooses the half to remove (as 'reduceDB()' does)
+ * while the search goes on. The plan is applied at the next restart, or at the next reduction if
+ * the run is not over by then. A reduction is skipped if the previous plan is not ready yet.
+ */
+
+void Solver::planReduceDB() {
+    if(planner == NULL) planner = new ReducePlanner();
+    if(planner->ready()) applyReducePlan();
+    if(planner->busy()) return;
+    nb_reducedb++;
+    if(dedup_learnts) removeDuplicates(learnts, nb_duplicate_learnts);
+
+    vec<ReducePlanner::Learnt> &snapshot = planner->snapshot;
+    snapshot.clear();
+    snapshot.capacity(learnts.size());
+    for(int i = 0; i < learnts.size(); i++) {
+        Clause &c = ca[learnts[i]];
+        uint32_t span = comm_reduce && nb_communities > 0 && c.size() > 2 ? communitySpan(c) : 0;
+        ReducePlanner::Learnt l = {learnts[i], (uint32_t) c.size(), span, (uint32_t) c.lbd(), c.activity()};
+        snapshot.push_(l);
+    }
+    planner->plan.capacity(snapshot.size());            // (the helper thread must not allocate: no handler there)
+    planner->epoch = gc_epoch;
+    planner->start(0.5);
+}
+
+
+/**
+ * Remove the clauses of the plan of 'planner' that are not locked by the current assignment, unless
+ * a garbage collection moved the clauses since the snapshot.
+ */
+
+void Solver::applyReducePlan() {
+    if(planner->epoch == gc_epoch) {
+        const vec<CRef> &plan = planner->plan;
+        for(int i = 0; i < plan.size(); i++) {
+            Clause &c = ca[plan[i]];
+            if(c.mark() != 1 && c.size() > 2 && !locked(c)) removeClause(plan[i]);
+        }
+        int i, j;
+        for(i = j = 0; i < learnts.size(); i++)
+            if(ca[learnts[i]].mark() != 1) learnts[j++] = learnts[i];
+        learnts.shrink(i - j);
+    }
+    planner->taken();
+    checkGarbage();
+}
+
+
+/**
+ * Remove the clauses of a list that are identical to another one of the list, keeping the copy with
+ * the lowest LBD (or the one that is locked, or else the first one). Clauses are grouped by hash
+ * value, then compared.
+ * @param cs the learnt clauses, or the original ones
+ * @param removed the counter of removed clauses
+ */
+
+void Solver::removeDuplicates(vec<CRef> &cs, uint64_t &removed) {
+    vec<uint64_t> keys;                                  // The hash value and the index of each clause
+    for(int i = 0; i < cs.size(); i++)
+        keys.push((uint64_t) ClauseHash(ca, dedup_lits)(cs[i]) << 32 | (uint32_t) i);
+    sort(keys);
+
+    for(int i = 0; i < keys.size();) {
+        int end = i + 1;
+        while(end < keys.size() && keys[end] >> 32 == keys[i] >> 32) end++;
+        for(int a = i; a < end; a++) {
+            CRef ca_ref = cs[(uint32_t) keys[a]];
+            Clause &c = ca[ca_ref];
+            if(c.mark() == 1) continue;
+            for(int k = 0; k < c.size(); k++) seen[var(c[k])] = 1 + sign(c[k]);
+            for(int b = a + 1; b < end; b++) {
+                CRef cb_ref = cs[(uint32_t) keys[b]];
+                Clause &d = ca[cb_ref];
+                if(d.mark() == 1 || d.size() != c.size()) continue;
+                int k;
+                for(k = 0; k < d.size() && seen[var(d[k])] == 1 + sign(d[k]); k++);
+                if(k < d.size()) continue;
+                bool keep_d = locked(d) || (!locked(c) && d.lbd() < c.lbd());
+                removeClause(keep_d ? ca_ref : cb_ref);
+                removed++;
+                if(keep_d) break;
+            }
+            for(int k = 0; k < c.size(); k++) seen[var(c[k])] = 0;
+        }
+        i = end;
+    }
+
+    int i, j;
+    for(i = j = 0; i < cs.size(); i++)
+        if(ca[cs[i]].mark() != 1) cs[j++] = cs[i];
+    cs.shrink(i - j);
+}
+
+
+/**
+ * Free memory when the clauses and the watches get close to the soft limit: remove most learnt
+ * clauses, collect the garbage and give the unused capacity of the watch lists back. Nothing is done
+ * if the learnt clauses are less than a quarter of the footprint: the next try waits until it grows
+ * by a quarter of the limit. If the limit is too low for the instance (a reduction frees less than a
+ * quarter of the limit, or comes less than 'min_gap' conflicts after the previous one), the margin
+ * allowed over the limit is doubled, so that the search keeps enough learnt clauses to progress.
+ */
+
+void Solver::reduceMemory() {
+    static const uint64_t min_gap = 10000;
+    uint64_t before = memoryFootprint();
+    uint64_t step = mem_soft_limit / 4;
+    uint64_t learnt_bytes = 0;
+    for(int i = 0; i < learnts.size(); i++)
+        learnt_bytes += ClauseAllocator::clauseBytes(ca[learnts[i]]) + 2 * sizeof(Watcher);
+    if(learnt_bytes * 4 < before) {
+        mem_margin = before - mem_soft_limit + step;
+        return;
+    }
+
+    nb_mem_reductions++;
+    reduceDB(0.9);
+    if(ca.wasted() > 0) garbageCollect();
+    watches.cleanAll();
+    watches_bin.cleanAll();
+    for(int i = 0; i < 4 * nVars(); i++) {
+        vec<Watcher> &ws = i & 1 ? watches_bin[toLit(i >> 1)] : watches[toLit(i >> 1)];
+        if(ws.capacity() == ws.size()) continue;
+        vec<Watcher> compact;
+        compact.capacity(ws.size());
+        for(int j = 0; j < ws.size(); j++) compact.push_(ws[j]);
+        compact.moveTo(ws);
+    }
+    uint64_t after = memoryFootprint();
+    if(after + step > before || (last_mem_reduction > 0 && conflicts - last_mem_reduction < min_gap))
+        mem_margin = mem_margin < step ? step : 2 * mem_margin;
+    last_mem_reduction = conflicts;
+    if(verbosity >= 1)
+        printf("c Soft memory limit reached: %" PRIu64 " MB => %" PRIu64 " MB (next reduction above %" PRIu64 " MB)\n",
+               before >> 20, after >> 20, (mem_soft_limit + mem_margin) >> 20);
+}
+
+
+/**
+ * Recover from an allocation failure in the search. The watch lists may be inconsistent at this point
+ * (e.g. if the failure occurred during propagation), so they are rebuilt once most learnt clauses
+ * have been removed, and the level-0 trail is propagated again.
+ */
+
+void Solver::recoverMemory() {
+    nb_mem_reductions++, nb_oom_recoveries++;
+    cancelUntil(0);
+    for(int i = 0; i < nVars(); i++) seen[i] = 0;
+    analyze_toclear.clear();
+    for(int i = 0; i < 2 * nVars(); i++) watches[toLit(i)].clear(true), watches_bin[toLit(i)].clear(true);
+
+    reduceDB(0.9);
+    if(ca.wasted() > 0) garbageCollect();
+    nb_lits_in_learnts = 0;
+    for(int i = 0; i < clauses.size(); i++) attachClause(clauses[i]);
+    for(int i = 0; i < learnts.size(); i++) attachClause(learnts[i]);
+    qhead = bin_qhead = 0;
+    if(verbosity >= 1)
+        printf("c Out of memory: %d learnt clauses kept, %" PRIu64 " MB used\n", learnts.size(), memoryFootprint() >> 20);
+}
+
+
+//=================================================================================================
+// Simplification at level 0
+//=================================================================================================
+
+
+/**
+ * Simplify the clause database according to the level-0 assignments: remove the satisfied clauses
+ * and the false literals of the others. Nothing is done if no literal was assigned since the last call.
+ * @return false if the formula is unsatisfiable
+ */
+
+bool Solver::simplify() {
+    assert(decisionLevel() == 0);
+    if(!ok) return false;
+
+    CRef confl = propagate();
+    if(confl != CRef_Undef) {
+        logEmptyClause(confl);
+        return ok = false;
+    }
+    if(nAssigns() == simpDB_assigns && released_vars.size() == 0) return true;
+
+    removeSatisfied(learnts);
+    removeSatisfied(clauses);
+
+    if(released_vars.size() > 0) {  // No clause refers to them any more: remove them from the trail and the heap
+        for(int i = 0; i < released_vars.size(); i++) {
+            assert(seen[released_vars[i]] == 0);
+            seen[released_vars[i]] = 1;
+        }
+        int i, j;
+        for(i = j = 0; i < trail.size(); i++)
+            if(seen[var(trail[i])] == 0)
+                trail[j++] = trail[i];
+        trail.shrink(i - j);
+        qhead = bin_qhead = trail.size();
+        for(int i = 0; i < released_vars.size(); i++) seen[released_vars[i]] = 0;
+        buildOrderHeap();
+
+        // Released variables are now ready to be reused:
+        append(released_vars, free_vars);
+        released_vars.clear();
+    }
+
+    checkGarbage();
+    simpDB_assigns = nAssigns();
+    return true;
+}
+
+
+/**
+ * Release a variable: its literal 'l' is made true at level 0, so the clauses containing 'l' are removed
+ * and 'l' is removed from the others by the next 'simplify()', after which 'newVar()' may reuse the
+ * variable. Typically 'l' is the negation of an activation literal whose clauses are retracted.
+ * Not supported with proof logging.
+ * @param l a literal whose variable is never referred to again (released only once)
+ */
+
+void Solver::releaseVar(Lit l) {
+    assert(proof == NULL && decisionLevel() == 0);
+    if(value(l) != l_True) {                   // (a false literal makes the formula unsatisfiable)
+        vec<Lit> unit;
+        unit.push(l);
+        addClause_(unit);
+    }
+    if(value(l) == l_True) released_vars.push(var(l));
+}
+
+
+bool Solver::satisfied(const Clause &c) const {
+    for(int i = 0; i < c.size(); i++)
+        if(value(c[i]) == l_True) return true;
+    return false;
+}
+
+
+void Solver::removeSatisfied(vec<CRef> &cs) {
+    int i, j;
+    for(i = j = 0; i < cs.size(); i++) {
+        if(satisfied(ca[cs[i]]))
+            removeClause(cs[i]);
+        else {
+            removeFalseLits(cs[i]);
+            cs[j++] = cs[i];
+        }
+    }
+    cs.shrink(i - j);
+}
+
+
+/**
+ * Remove the false literals of a clause which is not satisfied at level 0. Its two watched literals are
+ * then unassigned, so it stays attached. The shortened clause is a new clause for the proof (for LRAT,
+ * derived from the old one and the unit clauses of the removed literals).
+ * @param cr
+ */
+
+void Solver::removeFalseLits(CRef cr) {
+    Clause &c = ca[cr];
+    assert(value(c[0]) == l_Undef && value(c[1]) == l_Undef);
+    int k, l;
+    for(k = 2; k < c.size() && value(c[k]) != l_False; k++);
+    if(k == c.size()) return;
+
+    uint64_t id = 0;
+    if(proof != NULL) {
+        lrat_hints.clear();
+        if(lrat)
+            for(k = 2; k < c.size(); k++)
+                if(value(c[k]) == l_False) lrat_hints.push(unitId(var(c[k])));
+        proof_lits.clear();                                // (after 'unitId()', which logs clauses too)
+        for(k = 0; k < c.size(); k++)
+            if(value(c[k]) != l_False) proof_lits.push(c[k]);
+        if(lrat) lrat_hints.push(c.id()), id = ++next_clause_id;
+        proof->add(id, proof_lits, lrat_hints);
+        proof->remove(c.has_id() ? c.id() : 0, c);
+    }
+
+    for(k = l = 2; k < c.size(); k++)
+        if(value(c[k]) != l_False) c[l++] = c[k];
+    if(c.learnt()) nb_lits_in_learnts -= k - l;
+    if(l == 2) {                                           // Now binary: watched in 'watches_bin'
+        remove(watches[~c[0]], Watcher(cr, c[1]));
+        remove(watches[~c[1]], Watcher(cr, c[0]));
+        watches_bin[~c[0]].push(Watcher(cr, c[1]));
+        watches_bin[~c[1]].push(Watcher(cr, c[0]));
+    }
+    ca.shrink(cr, k - l);
+    if(c.has_extra() && !c.learnt()) c.calcAbstraction();
+    if(c.has_id() && lrat) {
+        if(c.learnt()) learnt_lifetimes.renamed(c.id(), id);      // The history goes on with the new identifier
+        c.id(id);
+    }
+    if(!c.learnt()) dedup_valid = false;
+}
+
+
+/**
+ * Write the original clauses in DIMACS, as simplified at level 0: the satisfied clauses and the false
+ * literals are left out. The variables keep their numbers.
+ * @param f
+ */
+
+void Solver::toDimacs(FILE *f) {
+    if(!ok) {
+        fprintf(f, "p cnf %d 1\n0\n", nVars());
+        return;
+    }
+
+    int cnt = 0;
+    for(int i = 0; i < clauses.size(); i++)
+        if(!satisfied(ca[clauses[i]])) cnt++;
+
+    fprintf(f, "p cnf %d %d\n", nVars(), cnt);
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        if(satisfied(c)) continue;
+        for(int j = 0; j < c.size(); j++)
+            if(value(c[j]) != l_False) fprintf(f, "%s%d ", sign(c[j]) ? "-" : "", var(c[j]) + 1);
+        fprintf(f, "0\n");
+    }
+}
+
+
+/**
+ * Write the level-0 assignments as unit clauses. Together with the clauses written by 'toDimacs()', they
+ * are equivalent to the original formula, and extend any model of the simplified one.
+ * @param f
+ */
+
+void Solver::writeFixed(FILE *f) {
+    int fixed = trail_lim.size() > 0 ? trail_lim[0] : trail.size();
+    fprintf(f, "p cnf %d %d\n", nVars(), fixed);
+    for(int i = 0; i < fixed; i++)
+        fprintf(f, "%s%d 0\n", sign(trail[i]) ? "-" : "", var(trail[i]) + 1);
+}
+
+
+/**
+ * Check a model, e.g. one given by a result cache, against the formula: the original clauses as
+ * stored, and the level-0 assignments (which the clauses removed when they were added depend on).
+ * @param m the value of each variable
+ */
+
+bool Solver::checkModel(const vec<lbool> &m) const {
+    if(!ok || m.size() < nVars()) return false;
+    for(int i = 0; i < trail.size(); i++)
+        if(level(var(trail[i])) == 0 && (m[var(trail[i])] ^ sign(trail[i])) != l_True) return false;
+    for(int i = 0; i < clauses.size(); i++) {
+        const Clause &c = ca[clauses[i]];
+        int j;
+        for(j = 0; j < c.size() && (m[var(c[j])] ^ sign(c[j])) != l_True; j++);
+        if(j == c.size()) return false;
+    }
+    return true;
+}
+
+
+//=================================================================================================
+// Inprocessing on the binary implication graph
+//=================================================================================================
+
+/**
+ * Simplify the binary implication graph at level 0: probe its roots with hyper-binary resolution,
+ * then remove its transitive binary clauses.
+ * @return FALSE if the formula is found unsatisfiable
+ */
+
+template<class P>
+bool Solver::inprocessBinaries() {
+    assert(decisionLevel() == 0);
+    if(!probeBinaries<P>() || !simplify()) return false;   // (no assigned literal is left in the clauses)
+    transitiveReduction();
+    inprocess_props = propagations;
+    return true;
+}
+
+
+/**
+ * Propagate at level 1 the roots of the binary implication graph (the literals implied by none).
+ * Binary clauses are propagated first, so a literal 'lit' implied by a longer clause is not reachable
+ * through binary clauses from the literals falsifying the clause. The hyper-binary resolvent
+ * (~dom | lit) is learnt, 'dom' being their dominator: the closest literal implying all of them
+ * through binary clauses (see 'dominator()'). The level-1 literals thus form a tree rooted in the
+ * root, whose edges are the binary reasons and the resolvents. A failed root gives a unit clause.
+ * The work is bounded by a tenth of the propagations made since the previous pass.
+ * @return FALSE if the formula is found unsatisfiable
+ */
+
+template<class P>
+bool Solver::probeBinaries() {
+    int64_t budget = (int64_t) ((propagations - inprocess_props) / 10) + 100000;
+    vec<Lit> lits, hbr, hbr_doms;
+    vec<uint64_t> hbr_ids;
+    int backtrack_level, lbd;
+    watches_bin.cleanAll();
+    probe_parent.growTo(nVars(), lit_Undef);
+    probe_depth.growTo(nVars(), 0);
+    probe_tree_id.growTo(nVars(), 0);
+
+    for(int n = 0; n < 2 * nVars() && budget > 0; n++) {
+        next_probe = (next_probe + 1) % (2 * nVars());
+        Lit root = toLit(next_probe);
+        if(value(root) != l_Undef || watches_bin[root].size() == 0 || watches_bin[~root].size() > 0) continue;
+
+        newDecisionLevel();
+        uncheckedEnqueue(root);
+        CRef confl = propagate_<P>();
+        budget -= trail.size() - trail_lim[0];
+
+        if(confl != CRef_Undef) {                            // Failed literal: a unit clause
+            analyze<P>(confl, lits, backtrack_level, lbd);
+            assert(lits.size() == 1);
+            cancelUntil(0);
+            uint64_t id = ++next_clause_id;
+            if(P::proof) proof->add(id, lits, lrat_hints);
+            uncheckedEnqueue(lits[0]);
+            if(P::lrat) unit_id[var(lits[0])] = id;
+            nb_failed_literals++;
+            if((confl = propagate_<P>()) != CRef_Undef) {
+                logEmptyClause(confl);
+                return false;
+            }
+            continue;
+        }
+
+        hbr.clear(), hbr_doms.clear(), hbr_ids.clear();
+        probe_depth[var(root)] = 0;
+        for(int i = trail_lim[0] + 1; i < trail.size(); i++) {
+            Lit x = trail[i];
+            const Clause &c = ca[reason(var(x))];
+            if(c.size() == 2) {                              // A tree edge
+                Lit p = ~(c[0] == x ? c[1] : c[0]);
+                probe_parent[var(x)] = p, probe_depth[var(x)] = probe_depth[var(p)] + 1;
+                if(P::lrat) probe_tree_id[var(x)] = c.id();
+                continue;
+            }
+            Lit dom = dominator(c, x, budget);
+            lits.clear();
+            lits.push(~dom), lits.push(x);
+            uint64_t id = ++next_clause_id;
+            if(P::lrat) budget -= hyperBinaryHints(c, x, dom);
+            if(P::proof) proof->add(id, lits, lrat_hints);
+            probe_parent[var(x)] = dom, probe_depth[var(x)] = probe_depth[var(dom)] + 1;
+            probe_tree_id[var(x)] = id;
+            hbr.push(x), hbr_doms.push(dom), hbr_ids.push(id);
+        }
+        cancelUntil(0);
+
+        for(int i = 0; i < hbr.size(); i++) {
+            lits.clear();
+            lits.push(~hbr_doms[i]), lits.push(hbr[i]);
+            CRef cr = ca.alloc(lits, true);
+            if(ca.clause_ids) ca[cr].id(hbr_ids[i]);
+            ca[cr].lbd(2);
+            learnts.push(cr);
+            attachClause(cr);
+        }
+        nb_hyper_binaries += hbr.size();
+    }
+    return true;
+}
+
+
+/**
+ * The dominator of the literals falsifying the clause 'c' at level 1 (the reason of 'x'): their
+ * closest common ancestor in the binary implication tree of the probed root, found by walking up the
+ * tree from each of them (the level-0 literals of 'c' are left out).
+ * @param work decreased by the number of tree edges walked
+ */
+
+Lit Solver::dominator(const Clause &c, Lit x, int64_t &work) {
+    Lit dom = lit_Undef;
+    for(int j = 0; j < c.size(); j++) {
+        if(c[j] == x || level(var(c[j])) == 0) continue;
+        Lit l = ~c[j];
+        if(dom == lit_Undef) {
+            dom = l;
+            continue;
+        }
+        for(; probe_depth[var(l)] > probe_depth[var(dom)]; work--) l = probe_parent[var(l)];
+        for(; probe_depth[var(dom)] > probe_depth[var(l)]; work--) dom = probe_parent[var(dom)];
+        for(; l != dom; work -= 2) l = probe_parent[var(l)], dom = probe_parent[var(dom)];
+    }
+    assert(dom != lit_Undef);   // (else 'x' would have been implied at level 0)
+    return dom;
+}
+
+
+struct probe_depth_lt {
+    const vec<int> &depth;
+
+    probe_depth_lt(const vec<int> &depth_) : depth(depth_) {}
+
+    bool operator()(Lit x, Lit y) const { return depth[var(x)] < depth[var(y)]; }
+};
+
+
+/**
+ * The LRAT hints of the hyper-binary resolvent (~dom | x), 'x' being implied at level 1 by the longer
+ * clause 'c': the unit clauses of the level-0 literals of 'c', then the tree edges from 'dom' down to
+ * the other literals of 'c', parents first, then 'c' itself.
+ * @return the number of literals looked at
+ */
+
+int Solver::hyperBinaryHints(const Clause &c, Lit x, Lit dom) {
+    lrat_hints.clear();
+    for(int j = 0; j < c.size(); j++) {
+        if(c[j] == x) continue;
+        if(level(var(c[j])) == 0) {
+            lrat_hints.push(unitId(var(c[j])));
+            continue;
+        }
+        for(Lit l = ~c[j]; l != dom && !seen[var(l)]; l = probe_parent[var(l)]) {
+            seen[var(l)] = 1;
+            analyze_toclear.push(l);
+        }
+    }
+    sort(analyze_toclear, probe_depth_lt(probe_depth));
+    for(int j = 0; j < analyze_toclear.size(); j++) {
+        lrat_hints.push(probe_tree_id[var(analyze_toclear[j])]);
+        seen[var(analyze_toclear[j])] = 0;
+    }
+    lrat_hints.push(c.id());
+    int looked_at = c.size() + analyze_toclear.size();
+    analyze_toclear.clear();
+    return looked_at;
+}
+
+
+/**
+ * Remove the binary clauses (~u | v) such that 'v' is reachable from 'u' through another edge of
+ * the binary implication graph. A depth-first search stamps each literal with its discovery and
+ * finish times: 'v' is a descendant of 'w' in the search forest if its interval is inside the one
+ * of 'w', and then reachable from 'w' through tree edges. The edge u -> v is transitive if 'u' has
+ * another child 'w' (not an ancestor of 'u', whose tree path could go through u -> v) with 'v' as a
+ * descendant. The clauses of the tree edges, in either direction, are kept, so that every clause
+ * removed is implied by the clauses left.
+ */
+
+void Solver::transitiveReduction() {
+    watches_bin.cleanAll();
+    int nlits = 2 * nVars();
+    vec<uint32_t> disc(nlits, 0), fin(nlits, 0);
+    vec<CRef> tree(nlits, CRef_Undef);                   // The clause of the tree edge to each literal
+    vec<Lit> stack;
+    vec<int> next;
+    uint32_t stamp = 0;
+    for(int pass = 0; pass < 2; pass++)                  // The roots first, for larger trees
+        for(int i = 0; i < nlits; i++) {
+            Lit root = toLit(i);
+            if(disc[i] != 0 || (pass == 0 && watches_bin[~root].size() > 0)) continue;
+            disc[i] = ++stamp;
+            stack.push(root), next.push(0);
+            while(stack.size() > 0) {
+                const vec<Watcher> &ws = watches_bin[stack.last()];
+                if(next.last() < ws.size()) {
+                    const Watcher &w = ws[next.last()++];
+                    if(disc[toInt(w.blocker)] == 0) {
+                        disc[toInt(w.blocker)] = ++stamp;
+                        tree[toInt(w.blocker)] = w.cref;
+                        stack.push(w.blocker), next.push(0);
+                    }
+                } else {
+                    fin[toInt(stack.last())] = ++stamp;
+                    stack.pop(), next.pop();
+                }
+            }
+        }
+
+    vec<uint64_t> children;                              // Discovery time << 32 | index in the watch list
+    vec<int> open;                                       // The children whose interval is open
+    for(int i = 0; i < nlits; i++) {
+        Lit u = toLit(i);
+        const vec<Watcher> &ws = watches_bin[u];
+        if(ws.size() < 2) continue;
+        children.clear();
+        for(int k = 0; k < ws.size(); k++)
+            children.push((uint64_t) disc[toInt(ws[k].blocker)] << 32 | (uint32_t) k);
+        sort(children);
+        open.clear();
+        for(int k = 0; k < children.size(); k++) {
+            const Watcher &w = ws[(uint32_t) children[k]];
+            if(ca[w.cref].mark() == 1) continue;
+            int v = toInt(w.blocker);
+            while(open.size() > 0 && fin[open.last()] < disc[v]) open.pop();
+            if(open.size() > 0 && fin[v] <= fin[open.last()]          // Inside an open interval
+               && tree[v] != w.cref && tree[toInt(~u)] != w.cref) {
+                assert(!locked(ca[w.cref]));
+                removeClause(w.cref);
+                nb_transitive++;
+            } else if(!(disc[v] <= disc[i] && fin[i] <= fin[v]))  // (not an ancestor of 'u')
+                open.push(v);
+        }
+    }
+
+    int i, j;
+    for(int l = 0; l < 2; l++) {
+        vec<CRef> &cs = l == 0 ? clauses : learnts;
+        for(i = j = 0; i < cs.size(); i++)
+            if(ca[cs[i]].mark() != 1) cs[j++] = cs[i];
+        cs.shrink(i - j);
+    }
+}
+
+
 //=================================================================================================
 // Add variables, clauses...
 //=================================================================================================
 
 
 /**
- * Add a new variable. Set the initial polarity
+ * Add a new variable (in the slot of a released variable if there is one). Set the initial polarity
  * @param sign the initial polarity
  * @return the index of the new variable (starting from 0)
  */
 
 Var Solver::newVar(bool sign) {
+    if(free_vars.size() > 0) {                 // Reuse the slot of a released variable
+        Var v = free_vars.last();
+        free_vars.pop();
+        assigns[v] = l_Undef;
+        vardata[v] = mkVarData(CRef_Undef, 0);
+        activity[v] = rnd_init_act ? drand(random_seed) * 0.00001 : 0;
+        seen[v] = 0;
+        unit_id[v] = 0;
+        polarity[v] = rnd_init_pol ? drand(random_seed) < 0.5 : sign;
+        if(occ_init && conflicts == 0) heap_pending = true;
+        else insertVarOrder(v);
+        return v;
+    }
+
     int v = nVars();
     watches.init(mkLit(v, false));             // The watched clauses for v
     watches.init(mkLit(v, true));              // The watched clauses for ~v
+    watches_bin.init(mkLit(v, false));
+    watches_bin.init(mkLit(v, true));
     assigns.push(l_Undef);                     // The variable is not assigned
     vardata.push(mkVarData(CRef_Undef, 0));    // varData.cr : store the reason of the literal, varData.l the level (if variable is assigned)
-    activity.push(0);                          // The initial activity
+    activity.push(rnd_init_act ? drand(random_seed) * 0.00001 : 0);   // The initial activity
     seen.push(0);                              // Useful for conflict analysis
-    polarity.push(sign);                       // The progress saving phase
-    insertVarOrder(v);                         // Add it to the heap (VSIDS)
+    unit_id.push(0);                           // LRAT: no unit clause yet
+    polarity.push(rnd_init_pol ? drand(random_seed) < 0.5 : sign);    // The progress saving phase
+    if(occ_init && conflicts == 0)             // The heap is built at once by 'initActivities()'
+        heap_pending = true;
+    else
+        insertVarOrder(v);                     // Add it to the heap (VSIDS)
     trail.capacity(v + 1);
     levelTagged.push(0);                       // For computing LBD
     return v;
@@ -404,34 +1458,275 @@ Var Solver::newVar(bool sign) {
 
 bool Solver::addClause_(vec<Lit> &ps) {
     assert(decisionLevel() == 0);
+    uint64_t id = ++next_clause_id;                        // Original clauses are numbered in input order
     if(!ok) return false;
 
     // Check if clause is satisfied and remove false/duplicate literals:
+    if(proof != NULL) ps.copyTo(add_tmp);                  // Keep the original clause for the proof
     sort(ps);
     Lit p;
     int i, j;
+    bool falsified = false;
     for(i = j = 0, p = lit_Undef; i < ps.size(); i++)       // Check all literals
         if(value(ps[i]) == l_True || ps[i] == ~p)           // A true literal: the clause is sat
             return true;
         else if(value(ps[i]) != l_False && ps[i] != p)
             ps[j++] = p = ps[i];                           // The literal is not false
+        else if(value(ps[i]) == l_False)
+            falsified = true;
     ps.shrink(i - j);                                      // Remove useless literals (false)
 
+    if(dedup_clauses && ps.size() > 1 && isDuplicate(ps)) { // Already stored
+        nb_duplicates++;
+        if(proof != NULL) proof->remove(id, add_tmp);
+        return true;
+    }
+
+    if(falsified && lrat) return addFalsifiedClause_(ps, id);
+    if(falsified && proof != NULL) {                       // DRAT: replace the original clause by the simplified one
+        proof->add(0, ps, lrat_hints);
+        proof->remove(0, add_tmp);
+    }
+    return storeClause_(ps, id);
+}
+
+
+/**
+ * Add an original clause without true, false or repeated literals: attach it, or enqueue and
+ * propagate its literal if it is unit.
+ * @param ps the literals of the clause
+ * @param id the identifier of the clause
+ * @return true if ok, false if a conflict occurs
+ */
+
+bool Solver::storeClause_(vec<Lit> &ps, uint64_t id) {
+    CRef confl = CRef_Undef;
     if(ps.size() == 0)                                     // Trivial unsat problem
         return ok = false;
-    else if(ps.size() == 1) {                              // Unit clause
+    else if(ps.size() == 1) {                            // Unit clause
         uncheckedEnqueue(ps[0]);                           // propagate the literal
-        return ok = (propagate() == CRef_Undef);
+        if(lrat) unit_id[var(ps[0])] = id;
+        confl = propagate();
     } else {
         CRef cr = ca.alloc(ps, false);                     // Create the clause
+        if(ca.clause_ids) ca[cr].id(id);
         clauses.push(cr);                                  // Add it
         attachClause(cr);                                  // Attach it
+        if(dedup_clauses && dedup_valid) dedup.insert(cr, 0);    // (otherwise rebuilt when needed)
     }
 
+    if(confl != CRef_Undef) {                              // The empty clause is logged by 'solve()'
+        empty_reason = confl;
+        return ok = false;
+    }
+    return true;
+}
+
+
+/**
+ * LRAT: add an original clause with some literals false at level 0. No clause can be derived before
+ * all original clauses are numbered, so the false literals are kept at the end of the stored clause
+ * (where they are never watched), and the clause is the reason of its last literal if it is unit.
+ * @param ps the literals of the clause which are not false
+ * @param id the identifier of the clause
+ * @return true if ok, false if a conflict occurs
+ */
+
+bool Solver::addFalsifiedClause_(vec<Lit> &ps, uint64_t id) {
+    int kept = ps.size();
+    for(int i = 0; i < add_tmp.size(); i++)
+        if(value(add_tmp[i]) == l_False && !seen[var(add_tmp[i])]) {
+            seen[var(add_tmp[i])] = 1;
+            ps.push(add_tmp[i]);
+        }
+    for(int i = kept; i < ps.size(); i++) seen[var(ps[i])] = 0;
+
+    CRef cr = ca.alloc(ps, false);
+    ca[cr].id(id);
+    if(kept == 0) {                                        // All literals are false
+        empty_reason = cr;
+        return ok = false;
+    }
+
+    clauses.push(cr);
+    attachClause(cr);
+    if(kept == 1) {
+        uncheckedEnqueue(ps[0], cr);
+        CRef confl = propagate();
+        if(confl != CRef_Undef) {
+            empty_reason = confl;
+            return ok = false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Add many clauses at once, from a buffer of DIMACS literals where each clause is ended by 0 (the
+ * last 0 may be missing). See 'beginBulk()'.
+ * @param lits the buffer
+ * @param size the number of literals in the buffer, 0s included
+ * @return false if the clauses are unsatisfiable
+ */
+
+bool Solver::addClauses(const int32_t *lits, int64_t size) {
+    int max_var = 0;
+    int64_t nclauses = 0;
+    for(int64_t i = 0; i < size; i++) {
+        if(lits[i] == 0) nclauses++;
+        else if(abs(lits[i]) > max_var) max_var = abs(lits[i]);
+    }
+    beginBulk(max_var, nclauses + 1, size - nclauses);
+
+    int64_t start = 0;
+    for(int64_t i = 0; i < size && ok; i++)
+        if(lits[i] == 0) {
+            addBulkClause_(lits + start, (int) (i - start));
+            start = i + 1;
+        }
+    if(start < size && ok) addBulkClause_(lits + start, (int) (size - start));
+    return endBulk();
+}
+
+
+/**
+ * Add many clauses at once, given in compressed sparse row form (without 0s). See 'beginBulk()'.
+ * @param offsets the first literal of each clause, then the end of the last one ('nclauses' + 1 entries)
+ * @param nclauses the number of clauses
+ * @param lits the DIMACS literals of the clauses
+ * @return false if the clauses are unsatisfiable
+ */
+
+bool Solver::addClauses(const int64_t *offsets, int64_t nclauses, const int32_t *lits) {
+    int max_var = 0;
+    for(int64_t i = offsets[0]; i < offsets[nclauses]; i++)
+        if(abs(lits[i]) > max_var) max_var = abs(lits[i]);
+    beginBulk(max_var, nclauses, offsets[nclauses] - offsets[0]);
+
+    for(int64_t i = 0; i < nclauses && ok; i++)
+        addBulkClause_(lits + offsets[i], (int) (offsets[i + 1] - offsets[i]));
+    return endBulk();
+}
+
+
+/**
+ * Prepare a bulk addition: create the variables, and reserve the memory of the clauses so that
+ * they are allocated one after the other. When the new clauses are at least as many as the stored
+ * ones, duplicates are removed once all are added (by sorting hash values) instead of looking each
+ * clause up in 'dedup'.
+ * @param max_var the largest DIMACS variable
+ * @param nclauses an upper bound on the number of clauses
+ * @param nlits an upper bound on the number of literals
+ */
+
+void Solver::beginBulk(int max_var, int64_t nclauses, int64_t nlits) {
+    while(nVars() < max_var) newVar();
+    if(nclauses < INT32_MAX - clauses.size()) clauses.capacity(clauses.size() + (int) nclauses);
+    ca.reserve(nclauses, nlits);
+
+    bulk_dedup = dedup_clauses && proof == NULL && nclauses >= clauses.size();
+    if(bulk_dedup) {
+        dedup.clear();
+        dedup_valid = false;
+    }
+}
+
+
+bool Solver::endBulk() {
+    if(bulk_dedup && ok) removeDuplicates(clauses, nb_duplicates);
+    bulk_dedup = false;
+    return ok;
+}
+
+
+/**
+ * Add a clause of a bulk addition. Unlike 'addClause_()', true, false and repeated literals are
+ * found with the marks of 'seen' instead of sorting the clause, so that the stored clause keeps the
+ * order of the buffer. With a proof, the clause is passed on to 'addClause_()'.
+ * @param lits the DIMACS literals of the clause
+ * @param size the number of literals
+ * @return true if ok, false if a conflict occurs
+ */
+
+bool Solver::addBulkClause_(const int32_t *lits, int size) {
+    vec<Lit> &ps = bulk_lits;
+    ps.clear();
+    for(int i = 0; i < size; i++) ps.push(lits[i] > 0 ? mkLit(lits[i] - 1) : ~mkLit(-lits[i] - 1));
+    if(proof != NULL) return addClause_(ps);
+
+    assert(decisionLevel() == 0);
+    uint64_t id = ++next_clause_id;
+    if(!ok) return false;
+
+    int i, j;
+    bool satisfied = false;
+    for(i = j = 0; i < ps.size(); i++) {
+        Lit p = ps[i];
+        if(value(p) == l_True || seen[var(p)] == 2 - sign(p)) {  // A true literal, or both signs: the clause is sat
+            satisfied = true;
+            break;
+        }
+        if(value(p) != l_False && seen[var(p)] == 0) {
+            seen[var(p)] = 1 + sign(p);
+            ps[j++] = p;
+        }
+    }
+    for(int k = 0; k < j; k++) seen[var(ps[k])] = 0;
+    if(satisfied) return true;
+    ps.shrink(i - j);
+
+    if(dedup_clauses && !bulk_dedup && ps.size() > 1 && isDuplicate(ps)) {
+        nb_duplicates++;
+        return true;
+    }
+    return storeClause_(ps, id);
+}
+
+
+uint32_t Solver::ClauseHash::operator()(CRef cr) const {
+    uint32_t sum = 0, xored = 0;
+    int size = cr == CRef_Undef ? pending.size() : ca[cr].size();
+    for(int i = 0; i < size; i++) {
+        uint32_t h = (uint32_t) toInt(cr == CRef_Undef ? pending[i] : ca[cr][i]) * 0x9E3779B1u;
+        h ^= h >> 16;
+        sum += h;
+        xored ^= h * 0x85EBCA6Bu;
+    }
+    return sum ^ (xored << 7 | xored >> 25);
+}
+
+
+bool Solver::ClauseEqual::operator()(CRef x, CRef y) const {
+    if(x == y) return true;
+    if(x != CRef_Undef && y != CRef_Undef) return false;
+    const Clause &c = ca[x == CRef_Undef ? y : x];
+    if(c.size() != pending.size()) return false;
+    for(int i = 0; i < c.size(); i++)
+        if(marks[var(c[i])] != 1 + sign(c[i])) return false;
     return true;
 }
 
 
+/**
+ * Look an original clause up, building the table of original clauses again if needed.
+ * @param ps the literals, sorted and without duplicates
+ */
+
+bool Solver::isDuplicate(const vec<Lit> &ps) {
+    if(!dedup_valid) {
+        dedup.clear();
+        for(int i = 0; i < clauses.size(); i++) dedup.insert(clauses[i], 0);
+        dedup_valid = true;
+    }
+    ps.copyTo(dedup_lits);
+    for(int i = 0; i < ps.size(); i++) seen[var(ps[i])] = 1 + sign(ps[i]);
+    bool found = dedup.has(CRef_Undef);
+    for(int i = 0; i < ps.size(); i++) seen[var(ps[i])] = 0;
+    return found;
+}
+
+
 /**
  * Attach a clause reference. Set the first two literals as sentinels.
  * @param cr
@@ -440,8 +1735,9 @@ bool Solver::addClause_(vec<Lit> &ps) {
 void Solver::attachClause(CRef cr) {
     const Clause &c = ca[cr];
     assert(c.size() > 1);
-    watches[~c[0]].push(Watcher(cr, c[1]));
-    watches[~c[1]].push(Watcher(cr, c[0]));
+    OccLists<Lit, vec<Watcher>, WatcherDeleted> &ws = c.size() == 2 ? watches_bin : watches;
+    ws[~c[0]].push(Watcher(cr, c[1]));
+    ws[~c[1]].push(Watcher(cr, c[0]));
     if(c.learnt())
         nb_lits_in_learnts += c.size();
 }
@@ -456,14 +1752,15 @@ void Solver::attachClause(CRef cr) {
 void Solver::detachClause(CRef cr, bool strict) {
     const Clause &c = ca[cr];
     assert(c.size() > 1);
+    OccLists<Lit, vec<Watcher>, WatcherDeleted> &ws = c.size() == 2 ? watches_bin : watches;
 
     if(strict) {
-        remove(watches[~c[0]], Watcher(cr, c[1]));
-        remove(watches[~c[1]], Watcher(cr, c[0]));
+        remove(ws[~c[0]], Watcher(cr, c[1]));
+        remove(ws[~c[1]], Watcher(cr, c[0]));
     } else {
         // Lazy detaching: (NOTE! Must clean all watcher lists before garbage collecting this clause)
-        watches.smudge(~c[0]);
-        watches.smudge(~c[1]);
+        ws.smudge(~c[0]);
+        ws.smudge(~c[1]);
     }
     if(c.learnt())
         nb_lits_in_learnts -= c.size();
@@ -478,11 +1775,23 @@ void Solver::detachClause(CRef cr, bool strict) {
 
 void Solver::removeClause(CRef cr) {
     Clause &c = ca[cr];
+    bool lock = locked(c);
+    if(lock) impliedFirst(c);
+    if(lock && lrat && level(var(c[0])) == 0) unitId(var(c[0]));  // The unit clause is derived from 'c'
+    if(lock && proof != NULL && !lrat && level(var(c[0])) == 0) {  // DRAT: keep the unit clause in the proof
+        proof_lits.clear();
+        proof_lits.push(c[0]);
+        proof->add(0, proof_lits, lrat_hints);
+    }
+    if(proof != NULL) proof->remove(c.has_id() ? c.id() : 0, c);
+    if(track_learnts && c.learnt() && c.has_id())
+        learnt_lifetimes.deleted(c.id(), conflicts);
     detachClause(cr);
     // Don't leave pointers to free'd memory!
-    if(locked(c)) vardata[var(c[0])].reason = CRef_Undef;
+    if(lock) vardata[var(c[0])].reason = CRef_Undef;
     c.mark(1);
     ca.free(cr);
+    if(!c.learnt()) dedup_valid = false;                            // ('dedup' may refer to it)
     nb_removed_clauses++;
 }
 
@@ -520,7 +1829,66 @@ void Solver::printIntermediateStats() {
 
 
 
-int Solver::computeLBD(vec<Lit> & lits) {
+//=================================================================================================
+// Proof logging
+//=================================================================================================
+
+
+void Solver::setProof(Proof *p) {
+    assert(nClauses() == 0 && next_clause_id == 0);
+    proof = p;
+    lrat = p->lrat();
+    ca.clause_ids |= lrat;
+}
+
+
+/**
+ * LRAT: log the unit clauses of the level-0 assignments, in trail order, until the one of 'x'. Each
+ * one is derived from the reason of the assignment and the unit clauses of its other literals.
+ * @param x a variable assigned at level 0
+ */
+
+void Solver::deriveUnits(Var x) {
+    assert(level(x) == 0 && value(x) != l_Undef);
+    while(unit_id[x] == 0) {
+        assert(unit_head < trail.size());
+        Lit p = trail[unit_head++];
+        if(unit_id[var(p)] != 0) continue;
+
+        const Clause &c = ca[reason(var(p))];
+        lrat_unit_hints.clear();
+        for(int i = 0; i < c.size(); i++)
+            if(c[i] != p) lrat_unit_hints.push(unit_id[var(c[i])]);
+        lrat_unit_hints.push(c.id());
+
+        unit_id[var(p)] = ++next_clause_id;
+        proof_lits.clear();
+        proof_lits.push(p);
+        proof->add(unit_id[var(p)], proof_lits, lrat_unit_hints);
+    }
+}
+
+
+/**
+ * Log the empty clause. For LRAT, it is derived from the unit clauses of the literals of 'confl'.
+ * @param confl a clause falsified at level 0
+ */
+
+void Solver::logEmptyClause(CRef confl) {
+    if(proof == NULL) return;
+    lrat_hints.clear();
+    if(lrat) {
+        for(int i = 0; i < ca[confl].size(); i++) lrat_hints.push(unitId(var(ca[confl][i])));
+        lrat_hints.push(ca[confl].id());
+    }
+    proof_lits.clear();
+    proof->add(++next_clause_id, proof_lits, lrat_hints);
+    proof->flush();
+}
+
+
+template<class Lits>
+int Solver::computeLBD(const Lits &lits) {
     int nblevels = 0;
     FLAG++;
     for(int i = 0; i < lits.size(); i++) {
@@ -545,9 +1913,30 @@ static const char *_cat = "CORE";
 
 static DoubleOption opt_var_decay(_cat, "var-decay", "The variable activity decay factor", 0.95, DoubleRange(0, false, 1, false));
 static DoubleOption opt_clause_decay(_cat, "cla-decay", "The clause activity decay factor", 0.999, DoubleRange(0, false, 1, false));
+static DoubleOption opt_random_var_freq(_cat, "rnd-freq", "The frequency with which the decision heuristic tries to choose a random variable", 0,
+                                       DoubleRange(0, true, 1, true));
+static DoubleOption opt_random_seed(_cat, "random-seed", "Used by the random variable selection", 91648253, DoubleRange(0, false, HUGE_VAL, false));
+static BoolOption opt_rnd_init_act(_cat, "rnd-init", "Randomize the initial activity", false);
+static BoolOption opt_rnd_init_pol(_cat, "rnd-init-pol", "Randomize the initial polarity", false);
+static BoolOption opt_occ_init(_cat, "occ-init", "Initialize the activities and polarities from the literal occurrences (Jeroslow-Wang)", false);
 static BoolOption opt_luby_restart(_cat, "luby", "Use the Luby restart sequence", true);
 static DoubleOption opt_garbage_frac(_cat, "gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered", 0.20,
                                      DoubleRange(0, false, HUGE_VAL, false));
+static BoolOption opt_dedup_clauses(_cat, "dedup", "Do not store duplicate original clauses", true);
+static BoolOption opt_dedup_learnts(_cat, "dedup-learnts", "Remove duplicate learnt clauses when reducing the database", false);
+static BoolOption opt_prop_stats(_cat, "prop-stats", "Record the watch lists and clauses visited by propagation (slower)", false);
+static BoolOption opt_track_learnts(_cat, "track-learnts", "Record the uses, propagations and deletion of each learnt clause (slower)", false);
+static BoolOption opt_bg_reduce(_cat, "bg-reduce", "Plan the reductions of the learnt clauses in a helper thread, applied at the next restart", false);
+static BoolOption opt_inprocess(_cat, "inprocess", "Remove transitive binary clauses and learn hyper-binary resolvents at restarts", false);
+static IntOption opt_inprocess_interval(_cat, "inprocess-int", "The conflicts between two simplifications of the binary clauses", 20000, IntRange(1, INT32_MAX));
+static BoolOption opt_comm_branch(_cat, "comm-branch", "Prefer the decisions in the community of the last decision", false);
+static DoubleOption opt_comm_ratio(_cat, "comm-ratio", "The part of the highest activity a decision in the community needs", 0.9, DoubleRange(0, true, 1, true));
+static BoolOption opt_comm_reduce(_cat, "comm-reduce", "Reduce first the learnt clauses spanning the most communities", false);
+static DoubleOption opt_comm_time(_cat, "comm-time", "The CPU time (in seconds) given to the computation of the communities", 2, DoubleRange(0, true, HUGE_VAL, false));
+static BoolOption opt_bandit(_cat, "bandit", "Choose the variable decay and the restart unit of each run with a bandit", false);
+static DoubleOption opt_bandit_explore(_cat, "bandit-explore", "The weight of the exploration term of the bandit", 0.1, DoubleRange(0, true, HUGE_VAL, false));
+static IntOption opt_mem_soft_lim(_cat, "mem-soft-lim", "Soft limit on the memory of clauses and watches, in megabytes (0 = none)", 0,
+                                  IntRange(0, INT32_MAX));
 
 
 Solver::Solver() :
@@ -555,15 +1944,34 @@ Solver::Solver() :
 // Parameters (user settable):
 //
         verbosity(0), var_decay(opt_var_decay), clause_decay(opt_clause_decay),
+        random_var_freq(opt_random_var_freq), random_seed(opt_random_seed),
+        rnd_init_act(opt_rnd_init_act), rnd_init_pol(opt_rnd_init_pol), occ_init(opt_occ_init),
         luby_restart(opt_luby_restart),
         nextReduceDB(2000),
         garbage_frac(opt_garbage_frac),
+        dedup_clauses(opt_dedup_clauses), dedup_learnts(opt_dedup_learnts),
+        mem_soft_limit((uint64_t) opt_mem_soft_lim << 20),
+        bandit(opt_bandit), bandit_explore(opt_bandit_explore), prop_stats(opt_prop_stats), track_learnts(opt_track_learnts),
+        bg_reduce(opt_bg_reduce), inprocess(opt_inprocess), inprocess_interval(opt_inprocess_interval),
+        comm_branch(opt_comm_branch), comm_ratio(opt_comm_ratio), comm_reduce(opt_comm_reduce), comm_time(opt_comm_time),
         // Statistics: (formerly in 'SolverStats')
         //
         starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0), nb_removed_clauses(0), nb_reducedb(0),
-        nb_resolutions(0), nb_lits_in_learnts(0),
-        ok(true),  cla_inc(1), var_inc(1), watches(WatcherDeleted(ca)), qhead(0),
-        order_heap(VarOrderLt(activity)), progress_estimate(0), FLAG(0)
+        nb_resolutions(0), nb_lits_in_learnts(0), nb_mem_reductions(0), nb_oom_recoveries(0),
+        nb_duplicates(0), nb_duplicate_learnts(0), nb_transitive(0), nb_hyper_binaries(0), nb_failed_literals(0), nb_communities(0), modularity(0),
+        sum_inv_lbd(0), solving(false),
+        ok(true),  cla_inc(1), var_inc(1), watches(WatcherDeleted(ca)), watches_bin(WatcherDeleted(ca)),
+        qhead(0), bin_qhead(0),
+        order_heap(VarOrderLt(activity)), progress_estimate(0), next_mem_check(0), mem_margin(0), last_mem_reduction(0),
+        next_inprocess(0), inprocess_props(0), next_probe(0),
+        curr_community(-1), comm_stamp_counter(0),
+        simpDB_assigns(-1), heap_pending(false),
+        solve_status(l_Undef), in_run(false), curr_restarts(0), run_arm(-1), run_limit(0), run_conflicts(0),
+        run_conflicts_before(0), run_inv_lbd_before(0), yield_conflicts(UINT64_MAX),
+        dedup(ClauseHash(ca, dedup_lits), ClauseEqual(ca, dedup_lits, seen)), dedup_valid(true), bulk_dedup(false),
+        planner(NULL), gc_epoch(0),
+        proof(NULL), lrat(false), next_clause_id(0), unit_head(0), empty_reason(CRef_Undef),
+        search_fn(&Solver::search_<SearchPolicy<false, false, false> >), FLAG(0)
 
         // Resource constraints:
         //
@@ -571,6 +1979,39 @@ Solver::Solver() :
 
 
 Solver::~Solver() {
+    delete planner;
+}
+
+
+/**
+ * Re-read the user settable parameters from their options, e.g. after a configuration has been
+ * selected for the instance (see 'ConfigTable').
+ */
+
+void Solver::updateParameters() {
+    var_decay = opt_var_decay;
+    clause_decay = opt_clause_decay;
+    random_var_freq = opt_random_var_freq;
+    random_seed = opt_random_seed;
+    rnd_init_act = opt_rnd_init_act;
+    rnd_init_pol = opt_rnd_init_pol;
+    occ_init = opt_occ_init;
+    luby_restart = opt_luby_restart;
+    garbage_frac = opt_garbage_frac;
+    mem_soft_limit = (uint64_t) opt_mem_soft_lim << 20;
+    dedup_clauses = opt_dedup_clauses;
+    dedup_learnts = opt_dedup_learnts;
+    bandit = opt_bandit;
+    bandit_explore = opt_bandit_explore;
+    prop_stats = opt_prop_stats;
+    track_learnts = opt_track_learnts;
+    bg_reduce = opt_bg_reduce;
+    inprocess = opt_inprocess;
+    inprocess_interval = opt_inprocess_interval;
+    comm_branch = opt_comm_branch;
+    comm_ratio = opt_comm_ratio;
+    comm_reduce = opt_comm_reduce;
+    comm_time = opt_comm_time;
 }
 
 
@@ -584,6 +2025,7 @@ void Solver::relocAll(ClauseAllocator &to) {
     //
     // for (int i = 0; i < watches.size(); i++)
     watches.cleanAll();
+    watches_bin.cleanAll();
     for(int v = 0; v < nVars(); v++)
         for(int s = 0; s < 2; s++) {
             Lit p = mkLit(v, s);
@@ -591,6 +2033,9 @@ void Solver::relocAll(ClauseAllocator &to) {
             vec<Watcher> &ws = watches[p];
             for(int j = 0; j < ws.size(); j++)
                 ca.reloc(ws[j].cref, to);
+            vec<Watcher> &bs = watches_bin[p];
+            for(int j = 0; j < bs.size(); j++)
+                ca.reloc(bs[j].cref, to);
         }
 
     // All reasons:
@@ -611,6 +2056,32 @@ void Solver::relocAll(ClauseAllocator &to) {
     //
     for(int i = 0; i < clauses.size(); i++)
         ca.reloc(clauses[i], to);
+
+    if(empty_reason != CRef_Undef)
+        ca.reloc(empty_reason, to);
+}
+
+
+uint64_t Solver::memoryFootprint() const { return ca.bytes() + watches.bytes() + watches_bin.bytes(); }
+
+
+void Solver::memoryUsage(MemoryUsage &usage) const {
+    usage.arena = ca.bytes();
+    usage.arena_live = (uint64_t) (ca.size() - ca.wasted()) * ClauseAllocator::Unit_Size;
+    usage.arena_wasted = (uint64_t) ca.wasted() * ClauseAllocator::Unit_Size;
+    usage.watches = watches.bytes() + watches_bin.bytes();
+    usage.clause_lists = clauses.bytes() + learnts.bytes();
+    usage.variables = assigns.bytes() + polarity.bytes() + vardata.bytes() + activity.bytes() + seen.bytes()
+                      + levelTagged.bytes() + unit_id.bytes() + community.bytes() + probe_parent.bytes()
+                      + probe_depth.bytes() + probe_tree_id.bytes();
+    usage.trail = trail.bytes() + trail_lim.bytes();
+    usage.heap = order_heap.bytes();
+    usage.other = model.bytes() + analyze_stack.bytes() + analyze_toclear.bytes() + add_tmp.bytes()
+                  + proof_lits.bytes() + lrat_units.bytes() + lrat_chain.bytes() + lrat_hints.bytes()
+                  + lrat_unit_hints.bytes() + dedup_lits.bytes() + conflict.bytes() + assumptions.bytes()
+                  + released_vars.bytes() + free_vars.bytes() + bulk_lits.bytes() + learnt_lifetimes.records.bytes();
+    usage.other += dedup.bytes() + comm_stamp.bytes();
+    if(planner != NULL) usage.other += planner->snapshot.bytes();   // (the plan may be in progress)
 }
 
 
@@ -618,8 +2089,13 @@ void Solver::garbageCollect() {
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted());
+    to.extra_clause_field = ca.extra_clause_field;
+    to.clause_ids = ca.clause_ids;
 
     relocAll(to);
+    gc_epoch++;
+    dedup.clear();                                       // (the references change)
+    dedup_valid = false;
     if(verbosity >= 2)
         printf("|  Garbage collection:   %12d bytes => %12d bytes             |\n",
                ca.size() * ClauseAllocator::Unit_Size, to.size() * ClauseAllocator::Unit_Size);
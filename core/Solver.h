@@ -4,14 +4,163 @@
 #include "mtl/Vec.h"
 #include "mtl/Heap.h"
 #include "mtl/Alg.h"
+#include "mtl/Map.h"
 #include "utils/Options.h"
+#include "utils/Histogram.h"
 #include "core/SolverTypes.h"
+#include "core/Proof.h"
 #include<iostream>
 #include <iomanip>
 
 
 namespace CDCL {
 
+    class SolveHandle;
+    class SolveExecutor;
+    class ReducePlanner;
+
+//=================================================================================================
+// MemoryUsage -- the bytes allocated by the structures of the solver (see 'Solver::memoryUsage()'):
+
+    struct MemoryUsage {
+        uint64_t arena;              // The clause arena (its capacity), of which:
+        uint64_t arena_live;         //   the clauses in use,
+        uint64_t arena_wasted;       //   the removed clauses not collected yet.
+        uint64_t watches;            // The watch lists.
+        uint64_t clause_lists;       // The lists of original and learnt clauses.
+        uint64_t variables;          // The per-variable vectors (assignments, reasons, activities...).
+        uint64_t trail;              // The trail and its level separators.
+        uint64_t heap;               // The decision heap.
+        uint64_t other;              // The model and the temporaries.
+
+        uint64_t total() const { return arena + watches + clause_lists + variables + trail + heap + other; }
+    };
+
+
+//=================================================================================================
+// BanditArm -- a setting of the heuristics, chosen at restarts by a bandit (see 'Solver::selectArm()'):
+
+    struct BanditArm {
+        double var_decay;            // The variable activity decay factor during the run.
+        int restart_unit;            // The number of conflicts of a run is this times the restart sequence.
+        int pulls;                   // The number of runs made with this arm.
+        double reward;               // The (recency-weighted) mean reward of these runs.
+    };
+
+
+//=================================================================================================
+// PropagationStats -- what 'Solver::propagate()' visits (if 'Solver::prop_stats' is set):
+
+    struct PropagationStats {
+        Histogram watch_lists;       // The length of each watch list visited.
+        Histogram clause_sizes;      // The size of each clause visited (i.e. whose blocker is not true).
+        Histogram replacements;      // The number of literals looked at for a new watch, per clause visited.
+        uint64_t watchers;           // The watchers of the longer clauses visited,
+        uint64_t blocker_hits;       //   skipped because their blocker is true,
+        uint64_t first_hits;         //   or because the other watched literal is true (after a clause dereference).
+        uint64_t bin_watchers;       // The watchers of the binary clauses visited (never dereferenced),
+        uint64_t bin_true;           //   whose other literal is true.
+
+        PropagationStats() : watchers(0), blocker_hits(0), first_hits(0), bin_watchers(0), bin_true(0) {}
+    };
+
+
+//=================================================================================================
+// SearchPolicy -- the features of the search fixed at compile time:
+//
+// 'Solver::search_()' and the loops it calls are instantiated for each policy. The instantiation
+// matching the proof and the instrumentation options is chosen when a search starts, so that
+// the features turned off cost no test in 'propagate_()' and 'analyze()'.
+
+    template<bool Proof, bool Lrat, bool Instrumented>
+    struct SearchPolicy {
+        static const bool proof = Proof;                 // Learnt clauses are written to 'Solver::proof',
+        static const bool lrat = Lrat;                   //   with LRAT hints.
+        static const bool instrumented = Instrumented;   // 'prop_stats' or 'track_learnts' may be set.
+    };
+
+
+//=================================================================================================
+// LearntLifetimes -- the history of each learnt clause (if 'Solver::track_learnts' is set), and of
+// the deleted ones grouped by initial LBD and by size:
+
+    struct LearntLifetimes {
+        struct Record {
+            uint64_t learnt_at;      // The conflict at which the clause was learnt.
+            uint32_t initial_lbd;
+            uint32_t size;           // The size when learnt.
+            uint32_t uses;           // The times it was resolved on by 'analyze()'.
+            uint32_t propagations;   // The literals it propagated.
+            uint32_t lbd;            // The LBD when last used (the initial LBD if never used).
+        };
+
+        struct Group {
+            uint64_t learnt;         // The clauses learnt,
+            uint64_t deleted;        //   of which deleted,
+            uint64_t unused;         //   without ever being used.
+            Histogram lifetime;      // The conflicts from learning to deletion, of the deleted clauses,
+            Histogram uses;          //   their uses,
+            Histogram propagations;  //   their propagations,
+            Histogram lbd;           //   and their LBD at last use.
+
+            Group() : learnt(0), deleted(0), unused(0) {}
+        };
+
+        struct IdHash {
+            uint32_t operator()(uint64_t id) const { return (uint32_t) (id ^ (id >> 32)); }
+        };
+
+        enum { nb_groups = 16 };
+        Map<uint64_t, Record, IdHash>
+                records;             // The learnt clauses not deleted yet, by clause identifier.
+        Group by_lbd[nb_groups];     // By initial LBD: 1, 2, ..., then 16 or more.
+        Group by_size[nb_groups];    // By size: 1, 2-3, 4-7, ..., then 2^15 or more.
+
+        static int lbdGroup(uint32_t lbd) { return lbd >= nb_groups ? nb_groups - 1 : lbd == 0 ? 0 : lbd - 1; }
+        static int sizeGroup(uint32_t size) {
+            int g = -1;
+            for(; size != 0; size >>= 1) g++;
+            return g < 0 ? 0 : g >= nb_groups ? nb_groups - 1 : g;
+        }
+
+        void learnt(uint64_t id, uint64_t conflict, int lbd, int size) {
+            Record r;
+            r.learnt_at = conflict, r.initial_lbd = r.lbd = lbd, r.size = size, r.uses = r.propagations = 0;
+            records.insert(id, r);
+            by_lbd[lbdGroup(lbd)].learnt++;
+            by_size[sizeGroup(size)].learnt++;
+        }
+
+        Record *record(uint64_t id) { return records.lookup(id); }   // NULL if the clause is not tracked.
+
+        // The clause got a new identifier (see 'Solver::removeFalseLits()'):
+        void renamed(uint64_t id, uint64_t new_id) {
+            Record *r = records.lookup(id);
+            if(r == NULL) return;
+            Record copy = *r;
+            records.remove(id);
+            records.insert(new_id, copy);
+        }
+
+        void deleted(uint64_t id, uint64_t conflict) {
+            Record *p = records.lookup(id);
+            if(p == NULL) return;
+            Record r = *p;
+            records.remove(id);
+            Group *gs[2] = {&by_lbd[lbdGroup(r.initial_lbd)], &by_size[sizeGroup(r.size)]};
+            for(int i = 0; i < 2; i++) {
+                Group &g = *gs[i];
+                g.deleted++;
+                if(r.uses == 0) g.unused++;
+                g.lifetime.add((uint32_t) (conflict - r.learnt_at));
+                g.uses.add(r.uses);
+                g.propagations.add(r.propagations);
+                g.lbd.add(r.lbd);
+            }
+        }
+    };
+
+
 //=================================================================================================
 // Solver -- the main class:
 
@@ -27,12 +176,34 @@ namespace CDCL {
         //
         Var newVar(bool polarity = true); // Add a new variable with parameters specifying variable mode.
         bool addClause_(vec<Lit> &ps);   // Add a clause to the solver without making superflous internal copy. Will change the passed vector 'ps'.
+        bool addClauses(const int32_t *lits, int64_t size); // Add DIMACS clauses, each ended by 0, from a buffer of 'size' literals.
+        bool addClauses(const int64_t *offsets, int64_t nclauses, const int32_t *lits); // Add DIMACS clauses in CSR form: clause 'i' is 'lits[offsets[i] .. offsets[i + 1] - 1]'.
+        void releaseVar(Lit l);          // Make literal true and promise to never refer to variable again (e.g. a retracted activation literal).
 
         // Solving:
         //
+        bool simplify();                // Removes already satisfied clauses and false literals (at level 0).
         lbool solve();                  // Search without assumptions.
+        lbool solve(const vec<Lit> &assumps); // Search for a model that respects a given set of assumptions.
+        void beginSolve(const vec<Lit> &assumps); // Start a search that is run by steps, see below.
+        lbool solveSteps(int64_t max_conflicts);  // Go on with the search for about 'max_conflicts' conflicts, then yield (see 'solving').
+        SolveHandle *solveAsync(SolveExecutor &executor, const vec<Lit> &assumps); // Search by steps on the threads of 'executor' (see 'core/Async.h').
         bool okay() const;              // FALSE means solver is in a conflicting state
 
+        // Instance features and configuration:
+        //
+        void computeFeatures(vec<double> &features, int samples = 10000, int probes = 64); // See 'core/Features.h'.
+        void computeCommunities();      // Communities of the variable interaction graph (see 'core/Communities.cc').
+        void updateParameters();        // Re-read the user settable parameters from the options.
+
+        // Proof logging:
+        //
+        void setProof(Proof *p);        // Log a DRAT or LRAT refutation (must be called before adding clauses).
+
+        // Output of the simplified formula:
+        //
+        void toDimacs(FILE *f);         // Write the original clauses, without level-0 assignments, in DIMACS.
+        void writeFixed(FILE *f);       // Write the level-0 assignments, as unit clauses (reconstruction stack).
 
 
         // Variable mode:
@@ -46,6 +217,7 @@ namespace CDCL {
         int nClauses() const;           // The current number of original clauses.
         int nLearnts() const;           // The current number of learnt clauses.
         int nVars() const;              // The current number of variables.
+        bool checkModel(const vec<lbool> &m) const; // TRUE if 'm' satisfies the clauses and the level-0 assignments.
 
         // Resource contraints:
         //
@@ -57,26 +229,59 @@ namespace CDCL {
 
         // Memory managment:
         //
-        virtual void garbageCollect();
+        void garbageCollect();
         void checkGarbage(double gf);
         void checkGarbage();
+        uint64_t memoryFootprint() const;           // Bytes used by the clauses and the watch lists (see 'mem_soft_limit').
+        void memoryUsage(MemoryUsage &usage) const; // Bytes used by each structure.
 
         // Extra results: (read-only member variable)
         //
         vec<lbool> model;               // If problem is satisfiable, this vector contains the model (if any).
+        vec<Lit> conflict;              // If problem is unsatisfiable (possibly under assumptions),
+                                        // this vector represent the final conflict clause expressed in the assumptions.
 
         // Mode of operation:
         //
         int verbosity;
         double var_decay;
         double clause_decay;
+        double random_var_freq;        // The frequency of random decisions.
+        double random_seed;            // The state of the random number generator (must never be 0).
+        bool rnd_init_act;             // Initialize the variable activities with small random values.
+        bool rnd_init_pol;             // Initialize the variable polarities randomly.
+        bool occ_init;                 // Initialize the activities and polarities from the literal occurrences.
         bool luby_restart;
         uint64_t nextReduceDB;
         double garbage_frac;           // The fraction of wasted memory allowed before a garbage collection is triggered.
+        bool dedup_clauses;            // Do not store original clauses identical to a stored one.
+        bool dedup_learnts;            // Remove duplicate learnt clauses when reducing the database.
+        uint64_t mem_soft_limit;       // Bytes of clauses and watches above which the solver frees memory (0 means no limit).
+        bool bandit;                   // Choose the heuristics of each run among 'arms'.
+        double bandit_explore;         // The weight of the exploration term of the bandit.
+        vec<BanditArm> arms;           // The settings the bandit chooses from (the defaults are set by 'solve()').
+        bool prop_stats;               // Record the watch lists and clauses visited by propagation in 'propagation_stats'.
+        bool track_learnts;            // Record the history of the learnt clauses in 'learnt_lifetimes'.
+        bool bg_reduce;                // Plan the reductions of the learnt clauses in a helper thread, see 'ReducePlanner'.
+        bool inprocess;                // Simplify the binary implication graph at restarts, see 'inprocessBinaries()'.
+        int inprocess_interval;        // The conflicts between two such simplifications.
+        bool comm_branch;              // Prefer the decisions in the community of the last decision, see 'pickInCommunity()'.
+        double comm_ratio;             // The part of the highest activity a decision in the community needs.
+        bool comm_reduce;              // Reduce first the learnt clauses spanning the most communities.
+        double comm_time;              // The CPU time (in seconds) given to 'computeCommunities()'.
 
         // Statistics
         uint64_t starts, decisions, rnd_decisions, propagations, conflicts, nb_removed_clauses, nb_reducedb;
         uint64_t nb_resolutions, nb_lits_in_learnts;
+        uint64_t nb_mem_reductions, nb_oom_recoveries;
+        uint64_t nb_duplicates, nb_duplicate_learnts;
+        uint64_t nb_transitive, nb_hyper_binaries, nb_failed_literals;
+        int nb_communities;            // Set by 'computeCommunities()', with the modularity of the partition.
+        double modularity;
+        double sum_inv_lbd;            // The sum of 1/LBD over the learnt clauses (the reward of the bandit).
+        bool solving;                  // TRUE while a search started by 'beginSolve()' is not over.
+        PropagationStats propagation_stats;
+        LearntLifetimes learnt_lifetimes;
 
     protected:
 
@@ -118,6 +323,23 @@ namespace CDCL {
             bool operator()(const Watcher &w) const { return ca[w.cref].mark() == 1; }
         };
 
+        // Hashing of clauses on their literals, in any order. The clause 'CRef_Undef' stands for the
+        // (sorted) literals of 'dedup_lits', whose variables are marked in 'seen' with 1 + their sign:
+        struct ClauseHash {
+            const ClauseAllocator &ca;
+            const vec<Lit> &pending;
+            ClauseHash(const ClauseAllocator &_ca, const vec<Lit> &p) : ca(_ca), pending(p) {}
+            uint32_t operator()(CRef cr) const;
+        };
+
+        struct ClauseEqual {
+            const ClauseAllocator &ca;
+            const vec<Lit> &pending;
+            const vec<char> &marks;
+            ClauseEqual(const ClauseAllocator &_ca, const vec<Lit> &p, const vec<char> &m) : ca(_ca), pending(p), marks(m) {}
+            bool operator()(CRef x, CRef y) const;   // (stored clauses are never duplicates of each other)
+        };
+
         struct VarOrderLt {
             const vec<double> &activity;
             bool operator()(Var x, Var y) const { return activity[x] > activity[y]; }
@@ -134,17 +356,68 @@ namespace CDCL {
         double var_inc;              // Amount to bump next variable with.
         OccLists<Lit, vec<Watcher>, WatcherDeleted>
                 watches;             // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+        OccLists<Lit, vec<Watcher>, WatcherDeleted>
+                watches_bin;         // The same for the binary clauses, whose blocker is the other literal.
         vec<lbool> assigns;          // The current assignments.
         vec<char> polarity;          // The preferred polarity of each variable.
         vec<Lit> trail;              // Assignment stack; stores all assigments made in the order they were made.
         vec<int> trail_lim;          // Separator indices for different decision levels in 'trail'.
         vec<VarData> vardata;        // Stores reason and level for each variable.
         int qhead;                   // Head of queue (as index into the trail -- no more explicit propagation queue in MiniSat).
+        int bin_qhead;               // Head of the queue of the binary clauses ('qhead' <= 'bin_qhead').
         Heap<VarOrderLt> order_heap; // A priority queue of variables ordered with respect to the variable activity.
         double progress_estimate;    // Set by 'search()'.
+        uint64_t next_mem_check;     // Number of conflicts at which the memory is checked against 'mem_soft_limit'.
+        uint64_t mem_margin;         // The bytes over 'mem_soft_limit' allowed before the next reduction (see 'reduceMemory()').
+        uint64_t last_mem_reduction; // Number of conflicts at the last reduction of the memory.
+        uint64_t next_inprocess;     // Number of conflicts at which the binary implication graph is simplified.
+        uint64_t inprocess_props;    // The propagations made before the end of the last simplification.
+        int next_probe;              // The literal after which the next probing starts.
+        vec<Lit> probe_parent;       // The parent of each literal in the binary implication tree of the probed root,
+        vec<int> probe_depth;        //   its depth in the tree,
+        vec<uint64_t> probe_tree_id; //   and the identifier of the binary clause (~parent | lit) (LRAT).
+        vec<int> community;          // The community of each variable (empty until 'computeCommunities()').
+        int curr_community;          // The community of the last decision, -1 if none.
+        vec<uint32_t> comm_stamp;    // The last clause seen in each community, see 'communitySpan()'.
+        uint32_t comm_stamp_counter;
+        int simpDB_assigns;          // Number of top-level assignments since last execution of 'simplify()'.
+        bool heap_pending;           // Variables were added without being inserted in 'order_heap' (see 'newVar()').
+        vec<Lit> assumptions;        // Current set of assumptions provided to solve by the user.
+
+        // State of the search between the steps of 'solveSteps()':
+        lbool solve_status;          // The result, once 'solving' is FALSE.
+        bool in_run;                 // A run (between two restarts) is going on.
+        int curr_restarts;           // The number of runs so far.
+        int run_arm;                 // The arm of the bandit chosen for the run, -1 if none.
+        int run_limit;               // The number of conflicts of the run.
+        int run_conflicts;           // The number of conflicts in the run so far.
+        uint64_t run_conflicts_before;
+        double run_inv_lbd_before;
+        uint64_t yield_conflicts;    // The search yields when reaching this number of conflicts.
+        vec<Var> released_vars;      // Variables released by 'releaseVar()', removed from the trail by the next 'simplify()'.
+        vec<Var> free_vars;          // Released variables whose slots are reused by 'newVar()'.
 
         ClauseAllocator ca;
 
+        vec<Lit> dedup_lits;         // The clause looked up in 'dedup'.
+        Map<CRef, char, ClauseHash, ClauseEqual>
+                dedup;               // The original clauses, while clauses are added (freed when solving).
+        bool dedup_valid;            // FALSE if 'dedup' has to be rebuilt before its next use.
+        bool bulk_dedup;             // The duplicates of the current bulk addition are removed at its end.
+        ReducePlanner *planner;      // The helper thread of 'bg_reduce', NULL until its first plan.
+        uint64_t gc_epoch;           // The garbage collections made (a plan made before one is dropped).
+
+        // Proof logging:
+        //
+        Proof *proof;                // The proof output, NULL if none.
+        bool lrat;                   // TRUE if the proof is LRAT (clauses then have identifiers).
+        uint64_t next_clause_id;     // Last identifier given. Original clauses are numbered in input order.
+        vec<uint64_t> unit_id;       // LRAT: identifier of the unit clause of a level-0 assignment, 0 if not logged yet.
+        int unit_head;               // LRAT: the unit clauses of all assignments in 'trail[0..unit_head)' are logged.
+        CRef empty_reason;           // A clause falsified at level 0 whose empty resolvent is not logged yet.
+
+        lbool (Solver::*search_fn)(int);   // The instantiation of 'search_()' run by 'search()'.
+
         // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which it is
         // used, exept 'seen' wich is used in several places.
         //
@@ -154,6 +427,9 @@ namespace CDCL {
         vec<Lit> analyze_stack;
         vec<Lit> analyze_toclear;
         vec<Lit> add_tmp;
+        vec<Lit> bulk_lits;
+        vec<Lit> proof_lits;
+        vec<uint64_t> lrat_units, lrat_chain, lrat_hints, lrat_unit_hints;
 
         // Resource contraints:
         //
@@ -164,16 +440,36 @@ namespace CDCL {
         // Main internal methods:
         //
         void insertVarOrder(Var x);                                          // Insert a variable in the decision order priority queue.
+        void initActivities();                                               // Jeroslow-Wang activities and polarities, from the clauses.
+        void buildOrderHeap();                                               // Build 'order_heap' from the unassigned variables.
         Lit pickBranchLit();                                                 // Return the next decision variable.
+        Var pickInCommunity();                                               // The decision variable of 'comm_branch'.
         void newDecisionLevel();                                             // Begins a new decision level.
         void uncheckedEnqueue(Lit p, CRef from = CRef_Undef);                // Enqueue a literal. Assumes value of literal is undefined.
         CRef propagate();                                                    // Perform unit propagation. Returns possibly conflicting clause.
+        template<class P> CRef propagate_();                                 // (specialised for the policy 'P', see 'SearchPolicy')
         void cancelUntil(int level);                                         // Backtrack until a certain level.
-        void analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int & lbd);    // (bt = backtrack)
+        template<class P> void analyze(CRef confl, vec<Lit> &out_learnt, int &out_btlevel, int & lbd);    // (bt = backtrack)
+        void analyzeFinal(Lit p, vec<Lit> &out_conflict);                    // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
         lbool search(int nof_conflicts);                                     // Search for a given number of conflicts.
+        template<class P> lbool search_(int nof_conflicts);                  // (specialised for the policy 'P')
+        void selectSearch();                                                 // Choose 'search_fn' from the options.
         lbool solve_();                                                      // Main solve method (assumptions given in 'assumptions').
-        void reduceDB();                                                     // Reduce the set of learnt clauses.
-        int computeLBD(vec<Lit> &lits);                                      // compute the LBD of a clause
+        void startSolve();                                                   // Start a search by steps (assumptions given in 'assumptions').
+        int selectArm();                                                     // The arm of the bandit used for the next run.
+        void rewardArm(int arm, uint64_t nof_conflicts, double inv_lbd);     // Update an arm after its run.
+        void reduceDB(double fraction = 0.5);                                // Reduce the set of learnt clauses.
+        void planReduceDB();                                                 // Start planning a reduction in the background.
+        int communitySpan(const Clause &c);                                  // The number of communities of the variables of 'c'.
+        template<class P> bool inprocessBinaries();                          // Simplify the binary implication graph (at level 0).
+        template<class P> bool probeBinaries();                              // Hyper-binary resolution and failed literals.
+        Lit dominator(const Clause &c, Lit x, int64_t &work);                // The closest tree ancestor of the other literals of 'c'.
+        int hyperBinaryHints(const Clause &c, Lit x, Lit dom);               // LRAT hints of a hyper-binary resolvent.
+        void transitiveReduction();                                          // Remove the transitive binary clauses.
+        void applyReducePlan();                                              // Apply the plan of 'planner' (if still valid).
+        void reduceMemory();                                                 // Free memory when approaching 'mem_soft_limit'.
+        void recoverMemory();                                                // Restore a usable state after a failed allocation.
+        template<class Lits> int computeLBD(const Lits &lits);               // compute the LBD of a clause
         // Maintaining Variable/Clause activity:
         //
         void varDecayActivity();                     // Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
@@ -187,20 +483,49 @@ namespace CDCL {
         void attachClause(CRef cr);                      // Attach a clause to watcher lists.
         void detachClause(CRef cr, bool strict = false); // Detach a clause to watcher lists.
         void removeClause(CRef cr);                      // Detach and free a clause.
+        bool satisfied(const Clause &c) const;           // Returns TRUE if a clause is satisfied in the current state.
+        void removeSatisfied(vec<CRef> &cs);             // Remove satisfied clauses, and the false literals of the others.
+        void removeFalseLits(CRef cr);                   // Remove the literals of a clause which are false at level 0.
+        bool addFalsifiedClause_(vec<Lit> &ps, uint64_t id); // LRAT: add a clause with literals false at level 0.
+        bool storeClause_(vec<Lit> &ps, uint64_t id);        // Add a simplified original clause (attached, or enqueued if unit).
+        void beginBulk(int max_var, int64_t nclauses, int64_t nlits); // Create the variables and reserve the memory of a bulk addition.
+        bool endBulk();                                      // Remove the duplicates of a bulk addition, if it was not done clause by clause.
+        bool addBulkClause_(const int32_t *lits, int size);  // Add a clause of a bulk addition (see 'addClauses()').
+        bool isDuplicate(const vec<Lit> &ps);            // Is there a stored original clause with these (sorted) literals?
+        void removeDuplicates(vec<CRef> &cs, uint64_t &removed); // Remove the clauses of 'cs' which have a duplicate in 'cs'.
         bool locked(const Clause &c) const;              // Returns TRUE if a clause is a reason for some implication in the current state.
+        void impliedFirst(Clause &c);                    // Put the implied literal of a reason first (binary clauses may have it second).
 
         void relocAll(ClauseAllocator &to);
 
+        // Proof logging:
+        //
+        uint64_t unitId(Var x);                          // LRAT: identifier of the unit clause of a level-0 assignment.
+        void deriveUnits(Var x);                         // LRAT: log the unit clauses of the level-0 trail up to 'x'.
+        void logEmptyClause(CRef confl);                 // Log the empty clause, from a clause falsified at level 0.
+
         // Misc:
         //
         int decisionLevel() const; // Gives the current decisionlevel.
         uint32_t abstractLevel(Var x) const; // Used to represent an abstraction of sets of decision levels.
         CRef reason(Var x) const;
         int level(Var x) const;
+        int communityOf(Var x) const;    // -1 if the variable has no community.
         double progressEstimate() const; // DELETE THIS ?? IT'S NOT VERY USEFUL ...
         bool withinBudget() const;
         void printIntermediateStats();
 
+        // Returns a random float 0 <= x < 1. Seed must never be 0.
+        static inline double drand(double &seed) {
+            seed *= 1389796;
+            int q = (int) (seed / 2147483647);
+            seed -= (double) q * 2147483647;
+            return seed / 2147483647;
+        }
+
+        // Returns a random integer 0 <= x < size. Seed must never be 0.
+        static inline int irand(double &seed, int size) { return (int) (drand(seed) * size); }
+
     };
 
 
@@ -213,6 +538,12 @@ namespace CDCL {
     inline int Solver::level(Var x) const { return vardata[x].level; }
 
 
+    inline uint64_t Solver::unitId(Var x) {
+        if(unit_id[x] == 0) deriveUnits(x);
+        return unit_id[x];
+    }
+
+
     inline void Solver::insertVarOrder(Var x) {
         if(!order_heap.inHeap(x)) order_heap.insert(x);
     }
@@ -260,7 +591,16 @@ namespace CDCL {
     }
 
 
-    inline bool Solver::locked(const Clause &c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c; }
+    inline bool Solver::locked(const Clause &c) const {
+        Lit p = c.size() == 2 && value(c[0]) != l_True ? c[1] : c[0];   // (see 'impliedFirst()')
+        return value(p) == l_True && reason(var(p)) != CRef_Undef && ca.lea(reason(var(p))) == &c; }
+
+    inline void Solver::impliedFirst(Clause &c) {
+        if(c.size() == 2 && value(c[0]) != l_True) {
+            Lit p = c[0];
+            c[0] = c[1], c[1] = p;
+        }
+    }
 
 
     inline void Solver::newDecisionLevel() { trail_lim.push(trail.size()); }
@@ -290,6 +630,9 @@ namespace CDCL {
     inline int Solver::nVars() const { return vardata.size(); }
 
 
+    inline int Solver::communityOf(Var x) const { return x < community.size() ? community[x] : -1; }
+
+
     inline void Solver::setConfBudget(int64_t x) { conflict_budget = conflicts + x; }
 
 
@@ -317,10 +660,25 @@ namespace CDCL {
 // all calls to solve must return an 'lbool'. I'm not yet sure which I prefer.
     inline lbool Solver::solve() {
         budgetOff();
+        assumptions.clear();
         return solve_();
     }
 
 
+    inline lbool Solver::solve(const vec<Lit> &assumps) {
+        budgetOff();
+        assumps.copyTo(assumptions);
+        return solve_();
+    }
+
+
+    inline void Solver::beginSolve(const vec<Lit> &assumps) {
+        budgetOff();
+        assumps.copyTo(assumptions);
+        startSolve();
+    }
+
+
     inline bool Solver::okay() const { return ok; }
 
 
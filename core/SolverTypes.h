@@ -156,9 +156,10 @@ namespace CDCL {
             unsigned mark      : 2;
             unsigned learnt    : 1;
             unsigned has_extra : 1;
+            unsigned has_id    : 1;
             unsigned reloced   : 1;
             unsigned size      : 18;
-            unsigned lbd       : 9;
+            unsigned lbd       : 8;
         }
                 header;
         union {
@@ -173,10 +174,11 @@ namespace CDCL {
 
         // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
         template<class V>
-        Clause(const V &ps, bool use_extra, bool learnt) {
+        Clause(const V &ps, bool use_extra, bool use_id, bool learnt) {
             header.mark = 0;
             header.learnt = learnt;
             header.has_extra = use_extra;
+            header.has_id = use_id;
             header.reloced = 0;
             header.size = ps.size();
             header.lbd = 0;
@@ -190,8 +192,13 @@ namespace CDCL {
                 else
                     calcAbstraction();
             }
+            if(header.has_id)
+                id(0);
         }
 
+        // Number of 32-bit words stored after the literals (extra field, then the two halves of the id):
+        int trailerSize() const { return header.has_extra + 2 * header.has_id; }
+
 
     public:
         void calcAbstraction() {
@@ -208,7 +215,7 @@ namespace CDCL {
 
         void shrink(int i) {
             assert(i <= size());
-            if(header.has_extra) data[header.size - i] = data[header.size];
+            for(int k = 0 ; k < trailerSize() ; k++) data[header.size - i + k] = data[header.size + k];
             header.size -= i;
         }
 
@@ -222,6 +229,9 @@ namespace CDCL {
         bool has_extra() const { return header.has_extra; }
 
 
+        bool has_id() const { return header.has_id; }
+
+
         uint32_t mark() const { return header.mark; }
 
 
@@ -234,7 +244,23 @@ namespace CDCL {
         int lbd() const { return header.lbd; }
 
 
-        void lbd(int l) { header.lbd = l; }
+        void lbd(int l) { header.lbd = l > 255 ? 255 : l; }
+
+
+        // A unique 64-bit identifier (used for LRAT proofs). Stored in two 32-bit words after the extra field:
+        uint64_t id() const {
+            assert(header.has_id);
+            int k = header.size + header.has_extra;
+            return (uint64_t) data[k].abs | ((uint64_t) data[k + 1].abs << 32);
+        }
+
+
+        void id(uint64_t i) {
+            assert(header.has_id);
+            int k = header.size + header.has_extra;
+            data[k].abs = (uint32_t) i;
+            data[k + 1].abs = (uint32_t) (i >> 32);
+        }
 
 
         bool reloced() const { return header.reloced; }
@@ -284,23 +310,28 @@ namespace CDCL {
     const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
 
     class ClauseAllocator : public RegionAllocator<uint32_t> {
-        static int clauseWord32Size(int size, bool has_extra) {
-            return (sizeof(Clause) + (sizeof(Lit) * (size + (int) has_extra))) / sizeof(uint32_t);
+        static int clauseWord32Size(int size, bool has_extra, bool has_id) {
+            return (sizeof(Clause) + (sizeof(Lit) * (size + (int) has_extra + 2 * (int) has_id))) / sizeof(uint32_t);
         }
 
 
     public:
         bool extra_clause_field;
+        bool clause_ids;                // Give every allocated clause a 64-bit identifier.
 
+        static uint64_t clauseBytes(const Clause &c) {
+            return (uint64_t) clauseWord32Size(c.size(), c.has_extra(), c.has_id()) * sizeof(uint32_t); }
 
-        ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false) {}
 
+        ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false), clause_ids(false) {}
 
-        ClauseAllocator() : extra_clause_field(false) {}
+
+        ClauseAllocator() : extra_clause_field(false), clause_ids(false) {}
 
 
         void moveTo(ClauseAllocator &to) {
             to.extra_clause_field = extra_clause_field;
+            to.clause_ids = clause_ids;
             RegionAllocator<uint32_t>::moveTo(to);
         }
 
@@ -311,13 +342,20 @@ namespace CDCL {
             assert(sizeof(float) == sizeof(uint32_t));
             bool use_extra = learnt | extra_clause_field;
 
-            CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), use_extra));
-            new(lea(cid)) Clause(ps, use_extra, learnt);
+            CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), use_extra, clause_ids));
+            new(lea(cid)) Clause(ps, use_extra, clause_ids, learnt);
 
             return cid;
         }
 
 
+        // Room for 'nclauses' more (non-learnt) clauses, with 'nlits' literals in all:
+        void reserve(int64_t nclauses, int64_t nlits) {
+            int64_t words = nclauses * clauseWord32Size(0, extra_clause_field, clause_ids) + nlits;
+            if(words <= UINT32_MAX) RegionAllocator<uint32_t>::reserve((uint32_t) words);
+        }
+
+
         // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
         Clause &operator[](Ref r) { return (Clause &) RegionAllocator<uint32_t>::operator[](r); }
 
@@ -336,7 +374,14 @@ namespace CDCL {
 
         void free(CRef cid) {
             Clause &c = operator[](cid);
-            RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.has_extra()));
+            RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.has_extra(), c.has_id()));
+        }
+
+
+        // Remove the last 'i' literals of a clause in place (their words are wasted until the next collection):
+        void shrink(CRef cid, int i) {
+            operator[](cid).shrink(i);
+            RegionAllocator<uint32_t>::free(i);
         }
 
 
@@ -357,6 +402,7 @@ namespace CDCL {
             to[cr].lbd(c.lbd());
             if(to[cr].learnt()) to[cr].activity() = c.activity();
             else if(to[cr].has_extra()) to[cr].calcAbstraction();
+            if(to[cr].has_id()) to[cr].id(c.has_id() ? c.id() : 0);
         }
     };
 
@@ -385,6 +431,14 @@ namespace CDCL {
         Vec &operator[](const Idx &idx) { return occs[toInt(idx)]; }
 
 
+        // Bytes allocated, the lists included:
+        uint64_t bytes() const {
+            uint64_t total = occs.bytes() + dirty.bytes() + dirties.bytes();
+            for(int i = 0 ; i < occs.size() ; i++) total += occs[i].bytes();
+            return total;
+        }
+
+
         Vec &lookup(const Idx &idx) {
             if(dirty[toInt(idx)]) clean(idx);
             return occs[toInt(idx)];
@@ -472,11 +526,14 @@ namespace CDCL {
         T &operator[](CRef cr) { return map[cr]; }
 
 
-        // Iteration (not transparent at all at the moment):
+        // Iteration over the slots of the table, of which the used ones hold a pair:
         int bucket_count() const { return map.bucket_count(); }
 
 
-        const vec<typename HashTable::Pair> &bucket(int i) const { return map.bucket(i); }
+        bool used(int i) const { return map.used(i); }
+
+
+        const typename HashTable::Pair &slot(int i) const { return map.slot(i); }
 
 
         // Move contents to other map:
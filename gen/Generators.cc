@@ -0,0 +1,165 @@
+#include <stdlib.h>
+
+#include "gen/Generators.h"
+
+using namespace CDCL;
+
+
+/**
+ * Uniform random k-SAT: each clause has 'k' distinct variables, with random signs.
+ * @param nvars the number of variables (at least 'k')
+ * @param ratio the number of clauses per variable
+ */
+
+void CDCL::randomKSat(ClauseSink &out, Random &rnd, int nvars, int k, double ratio) {
+    int64_t nclauses = (int64_t) (ratio * nvars + 0.5);
+    vec<int> lits;
+    for(int64_t c = 0; c < nclauses; c++) {
+        lits.clear();
+        while(lits.size() < k) {
+            int v = rnd.below(nvars) + 1;
+            int i;
+            for(i = 0; i < lits.size() && abs(lits[i]) != v; i++);
+            if(i == lits.size()) lits.push(rnd.flip() ? v : -v);
+        }
+        out.clause(lits);
+    }
+}
+
+
+/**
+ * The pigeonhole principle for 'holes' + 1 pigeons (unsatisfiable). Variable 'p * holes + h + 1'
+ * means that pigeon 'p' is in hole 'h'.
+ */
+
+void CDCL::pigeonHole(ClauseSink &out, int holes) {
+    vec<int> lits;
+    for(int p = 0; p <= holes; p++) {                    // Each pigeon is in a hole
+        lits.clear();
+        for(int h = 0; h < holes; h++) lits.push(p * holes + h + 1);
+        out.clause(lits);
+    }
+    for(int h = 0; h < holes; h++)                       // No two pigeons share a hole
+        for(int p = 0; p <= holes; p++)
+            for(int q = p + 1; q <= holes; q++) {
+                lits.clear();
+                lits.push(-(p * holes + h + 1));
+                lits.push(-(q * holes + h + 1));
+                out.clause(lits);
+            }
+}
+
+
+// c = a XOR b:
+static void xorClauses(ClauseSink &out, vec<int> &lits, int a, int b, int c) {
+    for(int s = 0; s < 4; s++) {                         // The 4 clauses with an odd number of negations
+        lits.clear();
+        lits.push(s & 1 ? -a : a);
+        lits.push(s & 2 ? -b : b);
+        lits.push((s == 0 || s == 3) ? -c : c);
+        out.clause(lits);
+    }
+}
+
+
+/**
+ * Two chains of XORs computing the parity of the same 'nvars' variables, in the order 1..n and in
+ * a random order, with a new variable for each intermediate result. The chains must give 1 and
+ * 0 (unsatisfiable), or both 1 if 'sat'. Every refutation has to relate the two orders.
+ */
+
+void CDCL::parityChains(ClauseSink &out, Random &rnd, int nvars, bool sat) {
+    vec<int> order, lits;
+    for(int i = 1; i <= nvars; i++) order.push(i);
+    int next_var = nvars + 1;
+    for(int chain = 0; chain < 2; chain++) {
+        if(chain == 1)
+            for(int i = nvars - 1; i > 0; i--) {         // Fisher-Yates
+                int j = rnd.below(i + 1);
+                int tmp = order[i];
+                order[i] = order[j], order[j] = tmp;
+            }
+        int acc = order[0];
+        for(int i = 1; i < nvars; i++) {
+            xorClauses(out, lits, acc, order[i], next_var);
+            acc = next_var++;
+        }
+        lits.clear();
+        lits.push(chain == 0 || sat ? acc : -acc);
+        out.clause(lits);
+    }
+}
+
+
+/**
+ * Colouring of the 'width' x 'height' grid, wrapped around (a torus) in each dimension of size 3
+ * or more. Variable 'cell * colours + c + 1' means that the cell has colour 'c'. With 2 colours it is
+ * unsatisfiable if a wrapped dimension is odd.
+ */
+
+void CDCL::gridColouring(ClauseSink &out, int width, int height, int colours) {
+    vec<int> lits;
+    for(int y = 0; y < height; y++)
+        for(int x = 0; x < width; x++) {
+            int cell = y * width + x;
+            lits.clear();                                // At least one colour
+            for(int c = 0; c < colours; c++) lits.push(cell * colours + c + 1);
+            out.clause(lits);
+            for(int c = 0; c < colours; c++)             // At most one colour
+                for(int d = c + 1; d < colours; d++) {
+                    lits.clear();
+                    lits.push(-(cell * colours + c + 1));
+                    lits.push(-(cell * colours + d + 1));
+                    out.clause(lits);
+                }
+
+            int neighbours[2] = {-1, -1};                // Right and down
+            if(x + 1 < width || width >= 3) neighbours[0] = y * width + (x + 1) % width;
+            if(y + 1 < height || height >= 3) neighbours[1] = ((y + 1) % height) * width + x;
+            for(int n = 0; n < 2; n++) {
+                if(neighbours[n] < 0) continue;
+                for(int c = 0; c < colours; c++) {
+                    lits.clear();
+                    lits.push(-(cell * colours + c + 1));
+                    lits.push(-(neighbours[n] * colours + c + 1));
+                    out.clause(lits);
+                }
+            }
+        }
+}
+
+
+/**
+ * Implications along a random order of the variables, each from a literal to the literal of the
+ * next variable (with a random sign per variable), mixed with random 3-clauses.
+ * @param nvars the number of variables (at least 3)
+ * @param ratio the number of clauses per variable
+ * @param binary_fraction the fraction of the clauses that are implications
+ */
+
+void CDCL::implicationChains(ClauseSink &out, Random &rnd, int nvars, double ratio, double binary_fraction) {
+    vec<int> order, lits;
+    for(int i = 1; i <= nvars; i++) order.push(rnd.flip() ? i : -i);
+    for(int i = nvars - 1; i > 0; i--) {
+        int j = rnd.below(i + 1);
+        int tmp = order[i];
+        order[i] = order[j], order[j] = tmp;
+    }
+
+    int64_t nclauses = (int64_t) (ratio * nvars + 0.5);
+    for(int64_t c = 0; c < nclauses; c++) {
+        lits.clear();
+        if(rnd.real() < binary_fraction) {
+            int i = rnd.below(nvars - 1);
+            lits.push(-order[i]);
+            lits.push(order[i + 1]);
+        } else
+            while(lits.size() < 3) {
+                int v = rnd.below(nvars) + 1;
+                int i;
+                for(i = 0; i < lits.size() && abs(lits[i]) != v; i++);
+                if(i == lits.size()) lits.push(rnd.flip() ? v : -v);
+            }
+        out.clause(lits);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef Minisat_Generators_h
+#define Minisat_Generators_h
+
+#include "mtl/Vec.h"
+#include "mtl/IntTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// Generators of parameterised instance families:
+//
+// Each generator writes its clauses, in DIMACS literals, to a 'ClauseSink'. The output only depends
+// on the parameters and the seed of the 'Random' given, so a generator can be run twice: first to
+// count the variables and clauses (which the DIMACS and binary headers need), then to write them.
+
+    class ClauseSink {
+    public:
+        virtual ~ClauseSink() {}
+        virtual void clause(const vec<int> &lits) = 0;
+    };
+
+
+    // The same sequence on every platform (SplitMix64):
+    class Random {
+        uint64_t state;
+
+    public:
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        int below(int n) { return (int) (next() % (uint64_t) n); }   // Uniform in [0, n[.
+        bool flip() { return next() >> 63; }
+        double real() { return (next() >> 11) * (1.0 / 9007199254740992.0); } // Uniform in [0, 1[.
+    };
+
+
+    void randomKSat(ClauseSink &out, Random &rnd, int nvars, int k, double ratio);
+    void pigeonHole(ClauseSink &out, int holes);
+    void parityChains(ClauseSink &out, Random &rnd, int nvars, bool sat);
+    void gridColouring(ClauseSink &out, int width, int height, int colours);
+    void implicationChains(ClauseSink &out, Random &rnd, int nvars, double ratio, double binary_fraction);
+
+//=================================================================================================
+}
+
+#endif
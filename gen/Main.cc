@@ -0,0 +1,142 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/Options.h"
+#include "gen/Generators.h"
+
+using namespace CDCL;
+
+//=================================================================================================
+// Sinks:
+
+
+namespace {
+    class Counter : public ClauseSink {
+    public:
+        int nvars;
+        int64_t nclauses;
+
+        Counter() : nvars(0), nclauses(0) {}
+
+        void clause(const vec<int> &lits) {
+            for(int i = 0; i < lits.size(); i++)
+                if(abs(lits[i]) > nvars) nvars = abs(lits[i]);
+            nclauses++;
+        }
+    };
+
+
+    // DIMACS text, or the binary CNF of 'minicdcl-server' (see 'server/Server.h'):
+    class Writer : public ClauseSink {
+        FILE *out;
+        bool binary;
+        char buf[16];
+
+        void word(uint32_t w) {
+            for(int i = 0; i < 4; i++) putc((w >> (8 * i)) & 0xFF, out);
+        }
+
+        void text(int x) {
+            char *p = buf + sizeof(buf);
+            unsigned int u = x < 0 ? -x : x;
+            do *--p = '0' + u % 10, u /= 10;
+            while(u != 0);
+            if(x < 0) *--p = '-';
+            fwrite(p, 1, buf + sizeof(buf) - p, out);
+        }
+
+    public:
+        Writer(FILE *f, bool b, int nvars, int64_t nclauses) : out(f), binary(b) {
+            if(binary) {
+                fwrite("BCNF", 1, 4, out);
+                word(nvars);
+                word((uint32_t) nclauses);
+            } else
+                fprintf(out, "p cnf %d %" PRIi64 "\n", nvars, nclauses);
+        }
+
+        void clause(const vec<int> &lits) {
+            for(int i = 0; i < lits.size(); i++)
+                if(binary) word(lits[i]);
+                else text(lits[i]), putc(' ', out);
+            if(binary) word(0);
+            else fputs("0\n", out);
+        }
+    };
+}
+
+
+//=================================================================================================
+// Main:
+
+
+int main(int argc, char **argv) {
+    setUsageHelp("USAGE: %s [options] <family> [output-file]\n\n"
+                 "  where family is one of: ksat, php, parity, grid, chains.\n"
+                 "  The instance is written to the standard output if no file is given.\n");
+
+    Int64Option seed("GEN", "seed", "Seed of the random families.", 1, Int64Range(0, INT64_MAX));
+    IntOption vars("GEN", "vars", "Number of variables (ksat, parity, chains).", 1000, IntRange(3, INT32_MAX));
+    IntOption k("GEN", "k", "Size of the clauses (ksat).", 3, IntRange(1, 64));
+    DoubleOption ratio("GEN", "ratio", "Number of clauses per variable (ksat, chains).", 4.26, DoubleRange(0, true, HUGE_VAL, false));
+    IntOption holes("GEN", "holes", "Number of holes (php).", 8, IntRange(1, 4096));
+    BoolOption sat("GEN", "sat", "Make the two chains agree, so that the instance is satisfiable (parity).", false);
+    IntOption width("GEN", "width", "Width of the grid (grid).", 15, IntRange(1, INT32_MAX));
+    IntOption height("GEN", "height", "Height of the grid (grid).", 15, IntRange(1, INT32_MAX));
+    IntOption colours("GEN", "colours", "Number of colours (grid).", 2, IntRange(1, 1024));
+    DoubleOption bin_frac("GEN", "bin-frac", "Fraction of binary implications (chains).", 0.8, DoubleRange(0, true, 1, true));
+    BoolOption binary("GEN", "binary", "Write the binary CNF read by minicdcl-server instead of DIMACS.", false);
+
+    parseOptions(argc, argv, true);
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "ERROR! Expected a family. Use '--help' for help.\n");
+        exit(1);
+    }
+    const char *family = argv[1];
+    if(strcmp(family, "ksat") == 0 && k > vars) {
+        fprintf(stderr, "ERROR! The clauses are larger than the number of variables.\n");
+        exit(1);
+    }
+    // The variables are numbered up to 'width * height * colours' (grid) or 3 * 'vars' - 2 (parity):
+    if((strcmp(family, "grid") == 0 && (int64_t) width * height > INT32_MAX / colours)
+       || (strcmp(family, "parity") == 0 && 3 * (int64_t) vars - 2 > INT32_MAX)) {
+        fprintf(stderr, "ERROR! The instance has too many variables.\n");
+        exit(1);
+    }
+
+    // The family is generated twice: to count, then to write.
+    Counter counter;
+    Writer *writer = NULL;
+    FILE *out = NULL;
+    for(int pass = 0; pass < 2; pass++) {
+        ClauseSink *sink = &counter;
+        if(pass == 1) {
+            out = argc == 3 ? fopen(argv[2], "wb") : stdout;
+            if(out == NULL)
+                fprintf(stderr, "ERROR! Could not open file: %s: %s\n", argv[2], strerror(errno)), exit(1);
+            sink = writer = new Writer(out, binary, counter.nvars, counter.nclauses);
+        }
+        Random rnd(seed);
+        if(strcmp(family, "ksat") == 0)
+            randomKSat(*sink, rnd, vars, k, ratio);
+        else if(strcmp(family, "php") == 0)
+            pigeonHole(*sink, holes);
+        else if(strcmp(family, "parity") == 0)
+            parityChains(*sink, rnd, vars, sat);
+        else if(strcmp(family, "grid") == 0)
+            gridColouring(*sink, width, height, colours);
+        else if(strcmp(family, "chains") == 0)
+            implicationChains(*sink, rnd, vars, ratio, bin_frac);
+        else {
+            fprintf(stderr, "ERROR! Unknown family: %s\n", family);
+            exit(1);
+        }
+    }
+    delete writer;
+
+    if(fclose(out) != 0)
+        fprintf(stderr, "ERROR! Could not write the instance: %s\n", strerror(errno)), exit(1);
+    return 0;
+}
@@ -34,10 +34,13 @@ class RegionAllocator
 
 
     uint32_t size      () const      { return sz; }
+    uint32_t capacity  () const      { return cap; }
     uint32_t wasted    () const      { return wasted_; }
+    uint64_t bytes     () const      { return (uint64_t)cap * sizeof(T); }
 
     Ref      alloc     (int size); 
     void     free      (int size)    { wasted_ += size; }
+    void     reserve   (uint32_t n)  { if (sz + n >= sz) capacity(sz + n); }     // Room for 'n' more units (ignored on overflow).
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
     T&       operator[](Ref r)       { assert(r >= 0 && r < sz); return memory[r]; }
@@ -67,22 +70,24 @@ void RegionAllocator<T>::capacity(uint32_t min_cap)
 {
     if (cap >= min_cap) return;
 
-    uint32_t prev_cap = cap;
-    while (cap < min_cap){
+    uint32_t new_cap = cap;
+    while (new_cap < min_cap){
         // NOTE: Multiply by a factor (13/8) without causing overflow, then add 2 and make the
         // result even by clearing the least significant bit. The resulting sequence of capacities
         // is carefully chosen to hit a maximum capacity that is close to the '2^32-1' limit when
         // using 'uint32_t' as indices so that as much as possible of this space can be used.
-        uint32_t delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;
-        cap += delta;
+        uint32_t delta = ((new_cap >> 1) + (new_cap >> 3) + 2) & ~1;
+        new_cap += delta;
 
-        if (cap <= prev_cap)
+        if (new_cap <= cap)
             throw OutOfMemoryException();
     }
-    // printf(" .. (%p) cap = %u\n", this, cap);
+    // printf(" .. (%p) cap = %u\n", this, new_cap);
 
-    assert(cap > 0);
-    memory = (T*)xrealloc(memory, sizeof(T)*cap);
+    // NOTE: the region is left unchanged if the allocation fails, so that the solver can recover.
+    assert(new_cap > 0);
+    memory = (T*)xrealloc(memory, sizeof(T)*new_cap);
+    cap = new_cap;
 }
 
 
@@ -56,6 +56,7 @@ class Heap {
     Heap(const Comp& c) : lt(c) { }
 
     int  size      ()          const { return heap.size(); }
+    uint64_t bytes     ()          const { return heap.bytes() + indices.bytes(); }
     bool empty     ()          const { return heap.size() == 0; }
     bool inHeap    (int n)     const { return n < indices.size() && indices[n] >= 0; }
     int  operator[](int index) const { assert(index < heap.size()); return heap[index]; }
@@ -95,7 +96,23 @@ class Heap {
         indices[x]       = -1;
         heap.pop();
         if (heap.size() > 1) percolateDown(0);
-        return x; 
+        return x;
+    }
+
+
+    // Remove any element, not only the minimum:
+    void remove(int n)
+    {
+        assert(inHeap(n));
+        int i      = indices[n];
+        int x      = heap.last();
+        indices[n] = -1;
+        heap.pop();
+        if (i < heap.size()){
+            heap   [i] = x;
+            indices[x] = i;
+            percolateUp(i);
+            percolateDown(indices[x]); }
     }
 
 
@@ -106,6 +123,7 @@ class Heap {
         heap.clear();
 
         for (int i = 0; i < ns.size(); i++){
+            indices.growTo(ns[i]+1, -1);
             indices[ns[i]] = i;
             heap.push(ns[i]); }
 
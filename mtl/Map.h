@@ -1,6 +1,13 @@
 #ifndef Minisat_Map_h
 #define Minisat_Map_h
 
+#include <string.h>
+#include <new>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "mtl/IntTypes.h"
 #include "mtl/Vec.h"
 
@@ -23,15 +30,46 @@ static inline uint32_t hash(int64_t x) { return (uint32_t)x; }
 
 
 //=================================================================================================
-// Some primes
+// Control bytes of the open-addressing table
 //
+// One byte per slot: 'ctrl_empty', 'ctrl_deleted', or the top 7 bits of the (mixed) hash of the
+// key stored in the slot. A lookup compares a group of 16 control bytes at once against these 7
+// bits, and only compares the keys of the matching slots.
 
-static const int nprimes          = 25;
-static const int primes [nprimes] = { 31, 73, 151, 313, 643, 1291, 2593, 5233, 10501, 21013, 42073, 84181, 168451, 337219, 674701, 1349473, 2699299, 5398891, 10798093, 21596719, 43193641, 86387383, 172775299, 345550609, 691101253 };
+enum { ctrl_empty = 0x80, ctrl_deleted = 0xFE, group_width = 16 };
+
+class CtrlGroup {
+#if defined(__SSE2__)
+    __m128i ctrl;
+ public:
+    explicit CtrlGroup(const uint8_t* p) : ctrl(_mm_loadu_si128((const __m128i*)p)) {}
+    uint32_t match    (uint8_t h) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h))); }
+    uint32_t matchFree()          const { return _mm_movemask_epi8(ctrl); }   // Empty or deleted (top bit set)
+#else
+    const uint8_t* ctrl;
+ public:
+    explicit CtrlGroup(const uint8_t* p) : ctrl(p) {}
+    uint32_t match    (uint8_t h) const { uint32_t m = 0; for (int i = 0; i < group_width; i++) m |= (uint32_t)(ctrl[i] == h) << i; return m; }
+    uint32_t matchFree()          const { uint32_t m = 0; for (int i = 0; i < group_width; i++) m |= (uint32_t)(ctrl[i] >> 7) << i; return m; }
+#endif
+    uint32_t matchEmpty()         const { return match(ctrl_empty); }
+};
+
+// Index of the lowest bit set ('m' != 0):
+static inline int lowestBit(uint32_t m) {
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    int i = 0; for (; (m & 1) == 0; m >>= 1) i++; return i;
+#endif
+}
 
 //=================================================================================================
 // Hash table implementation of Maps
 //
+// Open addressing in a power-of-two table of slots, probed by groups of 'group_width' slots along
+// a triangular sequence (which visits every group). The table grows at a load of 7/8, deleted
+// slots included, so that every probe sequence meets an empty slot.
 
 template<class K, class D, class H = Hash<K>, class E = Equal<K> >
 class Map {
@@ -42,130 +80,162 @@ class Map {
     H          hash;
     E          equals;
 
-    vec<Pair>* table;
+    uint8_t*   ctrl;      // 'cap' control bytes, followed by a copy of the first 'group_width' ones.
+    Pair*      table;
     int        cap;
     int        size;
+    int        deleted;
 
     // Don't allow copying (error prone):
     Map<K,D,H,E>&  operator = (Map<K,D,H,E>& other) { assert(0); }
                    Map        (Map<K,D,H,E>& other) { assert(0); }
 
-    bool    checkCap(int new_size) const { return new_size > cap; }
-
-    int32_t index  (const K& k) const { return hash(k) % cap; }
-    void   _insert (const K& k, const D& d) { 
-        vec<Pair>& ps = table[index(k)];
-        ps.push(); ps.last().key = k; ps.last().data = d; }
-
-    void    rehash () {
-        const vec<Pair>* old = table;
-
-        int old_cap = cap;
-        int newsize = primes[0];
-        for (int i = 1; newsize <= cap && i < nprimes; i++)
-           newsize = primes[i];
-
-        table = new vec<Pair>[newsize];
-        cap   = newsize;
-
-        for (int i = 0; i < old_cap; i++){
-            for (int j = 0; j < old[i].size(); j++){
-                _insert(old[i][j].key, old[i][j].data); }}
+    // The hash functions of the users may be weak in their low or high bits (e.g. the identity):
+    static uint32_t mix    (uint32_t h)       { return h * 0x9E3779B1u; }
+    static uint8_t  tag    (uint32_t m)       { return (uint8_t)(m >> 25); }
+    int             start  (uint32_t m) const { return (int)((m ^ (m >> 15)) & (uint32_t)(cap - 1)); }
+
+    void setCtrl(int i, uint8_t c) {
+        ctrl[i] = c;
+        if (i < group_width) ctrl[cap + i] = c; }
+
+    // Index of the slot of 'k', or -1:
+    int find(const K& k) const {
+        if (size == 0) return -1;
+        uint32_t m    = mix(hash(k));
+        uint8_t  t    = tag(m);
+        int      mask = cap - 1;
+        for (int pos = start(m), step = 0;; step += group_width, pos = (pos + step) & mask){
+            CtrlGroup g(ctrl + pos);
+            for (uint32_t bits = g.match(t); bits != 0; bits &= bits - 1){
+                int i = (pos + lowestBit(bits)) & mask;
+                if (equals(table[i].key, k)) return i; }
+            if (g.matchEmpty() != 0) return -1; }
+    }
 
-        delete [] old;
+    void _insert(const K& k, const D& d) {
+        uint32_t m    = mix(hash(k));
+        int      mask = cap - 1;
+        int      pos  = start(m);
+        uint32_t bits;
+        for (int step = 0; (bits = CtrlGroup(ctrl + pos).matchFree()) == 0; )
+            step += group_width, pos = (pos + step) & mask;
+        int i = (pos + lowestBit(bits)) & mask;
+        if (ctrl[i] == ctrl_deleted) deleted--;
+        setCtrl(i, tag(m));
+        table[i].key  = k;
+        table[i].data = d;
+    }
 
-        // printf(" --- rehashing, old-cap=%d, new-cap=%d\n", cap, newsize);
+    // Grow the table, or only drop the deleted slots if at most half of it is in use (the map is
+    // left unchanged if the new table cannot be allocated):
+    void rehash() {
+        int newsize = cap == 0 ? group_width : 2 * (size + 1) <= cap - cap / 8 ? cap : 2 * cap;
+
+        uint8_t* new_ctrl  = new (std::nothrow) uint8_t[newsize + group_width];
+        Pair*    new_table = new_ctrl == NULL ? NULL : new (std::nothrow) Pair[newsize];
+        if (new_table == NULL){
+            delete [] new_ctrl;
+            throw OutOfMemoryException(); }
+
+        uint8_t* old_ctrl  = ctrl;
+        Pair*    old_table = table;
+        int      old_cap   = cap;
+
+        ctrl    = new_ctrl;
+        table   = new_table;
+        cap     = newsize;
+        deleted = 0;
+        memset(ctrl, ctrl_empty, newsize + group_width);
+
+        for (int i = 0; i < old_cap; i++)
+            if (!(old_ctrl[i] & 0x80))
+                _insert(old_table[i].key, old_table[i].data);
+
+        delete [] old_ctrl;
+        delete [] old_table;
     }
 
-    
+
  public:
 
-    Map () : table(NULL), cap(0), size(0) {}
-    Map (const H& h, const E& e) : hash(h), equals(e), table(NULL), cap(0), size(0){}
-    ~Map () { delete [] table; }
+    Map () : ctrl(NULL), table(NULL), cap(0), size(0), deleted(0) {}
+    Map (const H& h, const E& e) : hash(h), equals(e), ctrl(NULL), table(NULL), cap(0), size(0), deleted(0) {}
+    ~Map () { delete [] ctrl; delete [] table; }
 
     // PRECONDITION: the key must already exist in the map.
     const D& operator [] (const K& k) const
     {
-        assert(size != 0);
-        const D*         res = NULL;
-        const vec<Pair>& ps  = table[index(k)];
-        for (int i = 0; i < ps.size(); i++)
-            if (equals(ps[i].key, k))
-                res = &ps[i].data;
-        assert(res != NULL);
-        return *res;
+        int i = find(k);
+        assert(i >= 0);
+        return table[i].data;
     }
 
     // PRECONDITION: the key must already exist in the map.
     D& operator [] (const K& k)
     {
-        assert(size != 0);
-        D*         res = NULL;
-        vec<Pair>& ps  = table[index(k)];
-        for (int i = 0; i < ps.size(); i++)
-            if (equals(ps[i].key, k))
-                res = &ps[i].data;
-        assert(res != NULL);
-        return *res;
+        int i = find(k);
+        assert(i >= 0);
+        return table[i].data;
     }
 
     // PRECONDITION: the key must *NOT* exist in the map.
-    void insert (const K& k, const D& d) { if (checkCap(size+1)) rehash(); _insert(k, d); size++; }
+    void insert (const K& k, const D& d) {
+        if (size + deleted + 1 > cap - cap / 8) rehash();
+        _insert(k, d); size++; }
+
     bool peek   (const K& k, D& d) const {
-        if (size == 0) return false;
-        const vec<Pair>& ps = table[index(k)];
-        for (int i = 0; i < ps.size(); i++)
-            if (equals(ps[i].key, k)){
-                d = ps[i].data;
-                return true; } 
-        return false;
+        int i = find(k);
+        if (i < 0) return false;
+        d = table[i].data;
+        return true;
     }
 
-    bool has   (const K& k) const {
-        if (size == 0) return false;
-        const vec<Pair>& ps = table[index(k)];
-        for (int i = 0; i < ps.size(); i++)
-            if (equals(ps[i].key, k))
-                return true;
-        return false;
-    }
+    bool has   (const K& k) const { return find(k) >= 0; }
+
+    // The data of the key, or NULL if it is not in the map (valid until the next insertion):
+    D*   lookup(const K& k) { int i = find(k); return i < 0 ? NULL : &table[i].data; }
 
     // PRECONDITION: the key must exist in the map.
     void remove(const K& k) {
-        assert(table != NULL);
-        vec<Pair>& ps = table[index(k)];
-        int j = 0;
-        for (; j < ps.size() && !equals(ps[j].key, k); j++);
-        assert(j < ps.size());
-        ps[j] = ps.last();
-        ps.pop();
+        int i = find(k);
+        assert(i >= 0);
+        setCtrl(i, ctrl_deleted);
         size--;
+        deleted++;
     }
 
     void clear  () {
-        cap = size = 0;
+        cap = size = deleted = 0;
+        delete [] ctrl;
         delete [] table;
+        ctrl  = NULL;
         table = NULL;
     }
 
-    int  elems() const { return size; }
-    int  bucket_count() const { return cap; }
+    int      elems() const { return size; }
+    int      bucket_count() const { return cap; }
+    uint64_t bytes() const { return cap == 0 ? 0 : (uint64_t)cap * (sizeof(Pair) + 1) + group_width; }
 
     // NOTE: the hash and equality objects are not moved by this method:
     void moveTo(Map& other){
+        delete [] other.ctrl;
         delete [] other.table;
 
-        other.table = table;
-        other.cap   = cap;
-        other.size  = size;
+        other.ctrl    = ctrl;
+        other.table   = table;
+        other.cap     = cap;
+        other.size    = size;
+        other.deleted = deleted;
 
+        ctrl  = NULL;
         table = NULL;
-        size = cap = 0;
+        size = cap = deleted = 0;
     }
 
-    // NOTE: given a bit more time, I could make a more C++-style iterator out of this:
-    const vec<Pair>& bucket(int i) const { return table[i]; }
+    // Iteration over the slots 0 .. 'bucket_count()' - 1, of which the used ones hold a pair:
+    bool        used(int i) const { return !(ctrl[i] & 0x80); }
+    const Pair& slot(int i) const { assert(used(i)); return table[i]; }
 };
 
 //=================================================================================================
@@ -45,6 +45,7 @@ public:
     void     shrink_  (int nelems)     { assert(nelems <= sz); sz -= nelems; }
     int      capacity (void) const     { return cap; }
     void     capacity (int min_cap);
+    uint64_t bytes    (void) const     { return (uint64_t)cap * sizeof(T); }   // Bytes allocated (not counting the elements' own memory).
     void     growTo   (int size);
     void     growTo   (int size, const T& pad);
     void     clear    (bool dealloc = false);
@@ -76,8 +77,11 @@ template<class T>
 void vec<T>::capacity(int min_cap) {
     if (cap >= min_cap) return;
     int add = imax((min_cap - cap + 1) & ~1, ((cap >> 1) + 2) & ~1);   // NOTE: grow by approximately 3/2
-    if (add > INT_MAX - cap || (((data = (T*)::realloc(data, (cap += add) * sizeof(T))) == NULL) && errno == ENOMEM))
-        throw OutOfMemoryException();
+    T*  new_data;
+    if (add > INT_MAX - cap || (((new_data = (T*)::realloc(data, (cap + add) * sizeof(T))) == NULL) && errno == ENOMEM))
+        throw OutOfMemoryException();                                  // (the vector is left unchanged)
+    data = new_data;
+    cap += add;
  }
 
 
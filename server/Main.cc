@@ -0,0 +1,59 @@
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+
+#include "utils/System.h"
+#include "utils/Options.h"
+#include "server/Server.h"
+
+using namespace CDCL;
+
+//=================================================================================================
+
+
+static SolverServer *server;
+
+static void SIGINT_stop(int) { server->stop(); }
+
+
+//=================================================================================================
+// Main:
+
+
+int main(int argc, char **argv) {
+    setUsageHelp("USAGE: %s [options] <socket-path>\n\n  where requests are described in 'server/Server.h'.\n");
+
+    IntOption verb("MAIN", "verb", "Verbosity level (0=silent, 1=some).", 1, IntRange(0, 1));
+    IntOption threads("MAIN", "threads", "Number of threads serving the connections.", 4, IntRange(1, 1024));
+    Int64Option conflicts("MAIN", "conflicts", "Conflict budget of a request that does not give one (-1 = none).", -1, Int64Range(-1, INT64_MAX));
+    IntOption max_input("MAIN", "max-input", "Largest formula accepted, in megabytes.", 256, IntRange(1, 2047));
+
+    parseOptions(argc, argv, true);
+    if(argc != 2) {
+        printf("c ERROR! Expected a socket path. Use '--help' for help.\n");
+        exit(1);
+    }
+
+    SolverServer S(argv[1], threads);
+    S.default_conflicts = conflicts;
+    S.max_input = max_input * 1024 * 1024;
+    if(!S.listen())
+        printf("c ERROR! Could not listen on %s: %s\n", argv[1], strerror(errno)), exit(1);
+
+    // Stop accepting connections on a signal (which may reach any thread: 'stop()' wakes 'loop()'):
+    server = &S;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIGINT_stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if(verb > 0) {
+        printf("c Listening on %s with %d threads\n", argv[1], (int) threads);
+        fflush(stdout);
+    }
+    S.loop();
+    if(verb > 0)
+        printf("c Stopped after %" PRIi64 " requests\n", S.nb_requests);
+    return 0;
+}
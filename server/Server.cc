@@ -0,0 +1,425 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "server/Server.h"
+
+using namespace CDCL;
+
+#define MAX_VARS (1 << 28)
+
+
+static double wallTime() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double) tv.tv_sec + (double) tv.tv_usec / 1000000;
+}
+
+//=================================================================================================
+// Connection -- buffered reads and writes on a socket:
+
+
+namespace {
+    class Connection {
+        int fd;
+        char buf[65536];
+        int pos, size;
+        vec<char> out;
+
+        bool fill() {
+            pos = 0;
+            do size = read(fd, buf, sizeof(buf));
+            while(size < 0 && errno == EINTR);
+            return size > 0;
+        }
+
+    public:
+        explicit Connection(int f) : fd(f), pos(0), size(0) {}
+
+        // Read a line, without its '\n', and NUL-terminated (FALSE at the end of the input).
+        bool readLine(vec<char> &line, int max) {
+            line.clear();
+            for(;;) {
+                if(pos == size && !fill()) return false;
+                char c = buf[pos++];
+                if(c == '\n') break;
+                if(line.size() == max) return false;
+                line.push(c);
+            }
+            line.push(0);
+            return true;
+        }
+
+        bool readBytes(vec<char> &data, int n) {
+            data.clear();
+            data.growTo(n + 1);         // (NUL-terminated)
+            data[n] = 0;
+            for(int i = 0; i < n;) {
+                if(pos == size && !fill()) return false;
+                int k = size - pos < n - i ? size - pos : n - i;
+                memcpy(&data[i], buf + pos, k);
+                pos += k, i += k;
+            }
+            return true;
+        }
+
+        // TRUE if the client has hung up (or sent another request, which is only read afterwards).
+        bool hungUp() {
+            struct pollfd p;
+            p.fd = fd, p.events = POLLIN, p.revents = 0;
+            if(pos < size || poll(&p, 1, 0) <= 0) return false;
+            if(p.revents & (POLLHUP | POLLERR)) return true;
+            char c;
+            return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+        }
+
+        void printf(const char *fmt, ...) {
+            char tmp[256];
+            va_list args;
+            va_start(args, fmt);
+            int n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+            va_end(args);
+            for(int i = 0; i < n && i < (int) sizeof(tmp) - 1; i++) out.push(tmp[i]);
+            if(out.size() >= 65536) flush();
+        }
+
+        bool flush() {
+            for(int i = 0; i < out.size();) {
+                int k = send(fd, &out[i], out.size() - i, MSG_NOSIGNAL);
+                if(k < 0 && errno == EINTR) continue;
+                if(k <= 0) {
+                    out.clear();
+                    return false;
+                }
+                i += k;
+            }
+            out.clear();
+            return true;
+        }
+    };
+}
+
+
+//=================================================================================================
+// Formula readers (they report errors instead of exiting, as the DIMACS parser does):
+
+
+static bool addLit(Solver &S, vec<Lit> &lits, int64_t parsed_lit, const char *&error) {
+    if(parsed_lit > MAX_VARS || parsed_lit < -MAX_VARS) {
+        error = "variable out of range";
+        return false;
+    }
+    int var = abs((int) parsed_lit) - 1;
+    while(var >= S.nVars()) S.newVar();
+    lits.push(parsed_lit > 0 ? mkLit(var) : ~mkLit(var));
+    return true;
+}
+
+
+static bool readText(const char *in, Solver &S, const char *&error) {
+    vec<Lit> lits;
+    for(;;) {
+        while((*in >= 9 && *in <= 13) || *in == 32) in++;
+        if(*in == 0) break;
+        if(*in == 'c' || *in == 'p') {
+            while(*in != 0 && *in != '\n') in++;
+            continue;
+        }
+        bool neg = *in == '-';
+        if(neg) in++;
+        if(*in < '0' || *in > '9') {
+            error = "unexpected character";
+            return false;
+        }
+        int64_t val = 0;
+        while(*in >= '0' && *in <= '9' && val <= MAX_VARS) val = val * 10 + (*in++ - '0');
+        if(val == 0) {
+            S.addClause_(lits);
+            lits.clear();
+        } else if(!addLit(S, lits, neg ? -val : val, error))
+            return false;
+    }
+    if(lits.size() > 0) {
+        error = "last clause not ended by 0";
+        return false;
+    }
+    return true;
+}
+
+
+static uint32_t word(const vec<char> &data, int i) {
+    const unsigned char *p = (const unsigned char *) &data[4 * i];
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+
+static bool readBinary(vec<char> &data, Solver &S, const char *&error) {
+    int nwords = (data.size() - 1) / 4;     // (without the NUL)
+    if(nwords < 3 || memcmp(&data[0], "BCNF", 4) != 0 || (data.size() - 1) % 4 != 0) {
+        error = "not a binary CNF";
+        return false;
+    }
+    int32_t *lits = (int32_t *) &data[12];
+    int64_t size = nwords - 3;
+    for(int64_t i = 0; i < size; i++) {
+        lits[i] = (int32_t) word(data, i + 3);  // (in place, a no-op on little-endian machines)
+        if(lits[i] > MAX_VARS || lits[i] < -MAX_VARS) {
+            error = "variable out of range";
+            return false;
+        }
+    }
+    if(size > 0 && lits[size - 1] != 0) {
+        error = "last clause not ended by 0";
+        return false;
+    }
+    if(word(data, 1) > MAX_VARS) {
+        error = "variable out of range";
+        return false;
+    }
+    while(S.nVars() < (int) word(data, 1)) S.newVar();
+    S.addClauses(lits, size);
+    return true;
+}
+
+
+//=================================================================================================
+// SolverServer:
+
+
+SolverServer::SolverServer(const char *p, int nb_threads) :
+        path(strdup(p)), listen_fd(-1), head(0), stopping(0), default_conflicts(-1), max_input(INT32_MAX - 1),
+        nb_requests(0) {
+    wake_fds[0] = wake_fds[1] = -1;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&pending, NULL);
+    threads.growTo(nb_threads);
+    for(int i = 0; i < nb_threads; i++)
+        pthread_create(&threads[i], NULL, worker, this);
+}
+
+
+SolverServer::~SolverServer() {
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    for(int i = 0; i < active.size(); i++) shutdown(active[i], SHUT_RD);     // (the searches see a hang-up)
+    pthread_cond_broadcast(&pending);
+    pthread_mutex_unlock(&lock);
+    for(int i = 0; i < threads.size(); i++)
+        pthread_join(threads[i], NULL);
+    for(int i = head; i < connections.size(); i++) close(connections[i]);
+    if(listen_fd >= 0) {
+        close(listen_fd);
+        unlink(path);
+    }
+    for(int i = 0; i < 2; i++)
+        if(wake_fds[i] >= 0) close(wake_fds[i]);
+    pthread_cond_destroy(&pending);
+    pthread_mutex_destroy(&lock);
+    free(path);
+}
+
+
+Solver *SolverServer::newSolver() {
+    Solver *S = new Solver();
+    S->verbosity = 0;
+    return S;
+}
+
+
+/**
+ * Create the socket, replacing a stale one left by a previous server.
+ * @return false on error
+ */
+
+bool SolverServer::listen() {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+
+    if(pipe(wake_fds) < 0) return false;
+    fcntl(wake_fds[1], F_SETFL, O_NONBLOCK);            // ('stop()' must not block if it is called again)
+
+    struct stat st;
+    if(stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listen_fd < 0) return false;
+    if(bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || ::listen(listen_fd, 64) < 0) {
+        int e = errno;
+        close(listen_fd);
+        listen_fd = -1;
+        errno = e;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Accept connections until 'stop()', which wakes the wait through 'wake_fds' whichever thread the
+ * signal was delivered to, and even if it came just before the wait.
+ */
+
+void SolverServer::loop() {
+    struct pollfd fds[2];
+    fds[0].fd = listen_fd, fds[0].events = POLLIN;
+    fds[1].fd = wake_fds[0], fds[1].events = POLLIN;
+    while(!stopping) {
+        if(poll(fds, 2, -1) < 0 || !(fds[0].revents & POLLIN)) continue;   // (EINTR, or woken by 'stop()')
+        int fd = accept(listen_fd, NULL, NULL);
+        if(fd < 0) continue;
+        pthread_mutex_lock(&lock);
+        connections.push(fd);
+        pthread_cond_signal(&pending);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+
+void SolverServer::stop() {
+    int e = errno;                                      // (called from signal handlers)
+    stopping = 1;
+    if(wake_fds[1] >= 0 && write(wake_fds[1], "", 1) < 0) {}
+    errno = e;
+}
+
+
+void *SolverServer::worker(void *server) {
+    ((SolverServer *) server)->run();
+    return NULL;
+}
+
+
+void SolverServer::run() {
+    Solver *spare = newSolver();
+    for(;;) {
+        pthread_mutex_lock(&lock);
+        while(head == connections.size() && !stopping) pthread_cond_wait(&pending, &lock);
+        if(stopping) {
+            pthread_mutex_unlock(&lock);
+            break;
+        }
+        int fd = connections[head++];
+        if(head == connections.size()) connections.clear(), head = 0;
+        active.push(fd);
+        pthread_mutex_unlock(&lock);
+
+        serve(fd, spare);
+
+        pthread_mutex_lock(&lock);
+        remove(active, fd);
+        pthread_mutex_unlock(&lock);
+        close(fd);
+    }
+    delete spare;
+}
+
+
+/**
+ * Answer the requests of a connection until it is closed. Each request is solved by 'spare',
+ * which is replaced by a new solver once the reply is sent.
+ */
+
+void SolverServer::serve(int fd, Solver *&spare) {
+    Connection c(fd);
+    vec<char> line, data;
+    while(!stopping && c.readLine(line, 1024)) {
+        char format[8];
+        int bytes, n;
+        if(sscanf(&line[0], "solve %7s %d%n", format, &bytes, &n) != 2 || bytes < 0 ||
+           (strcmp(format, "cnf") != 0 && strcmp(format, "bcnf") != 0)) {
+            c.printf("e invalid request\n");
+            c.flush();
+            return;
+        }
+        if(bytes > max_input) {
+            c.printf("e formula too large (at most %d bytes)\n", max_input);
+            c.flush();
+            return;
+        }
+
+        int64_t conflicts = default_conflicts;
+        double seed = 0;
+        bool send_model = true;
+        const char *error = NULL;
+        char *save;
+        for(char *opt = strtok_r(&line[n], " \t\r", &save); opt != NULL; opt = strtok_r(NULL, " \t\r", &save)) {
+            long long v;
+            char key[16];
+            if(sscanf(opt, "%15[^=]=%lld", key, &v) != 2)
+                error = "invalid option";
+            else if(strcmp(key, "conflicts") == 0)
+                conflicts = v;
+            else if(strcmp(key, "seed") == 0 && v > 0)
+                seed = (double) v;
+            else if(strcmp(key, "model") == 0)
+                send_model = v != 0;
+            else
+                error = "unknown option";
+        }
+        if(!c.readBytes(data, bytes)) return;
+
+        pthread_mutex_lock(&lock);
+        nb_requests++;
+        pthread_mutex_unlock(&lock);
+
+        Solver *S = spare;
+        spare = NULL;
+        double initial_time = wallTime();
+        lbool result = l_Undef;
+        try {
+            if(error == NULL) {
+                if(seed > 0) S->random_seed = seed;
+                if(strcmp(format, "cnf") == 0)
+                    readText(&data[0], *S, error);
+                else
+                    readBinary(data, *S, error);
+            }
+            if(error == NULL) {
+                vec<Lit> dummy;
+                S->beginSolve(dummy);
+                if(conflicts >= 0) S->setConfBudget(conflicts);
+                do {
+                    result = S->solveSteps(10000);
+                    if(c.hungUp()) S->interrupt();
+                } while(S->solving);
+            }
+        } catch(OutOfMemoryException &) {
+            error = "out of memory";
+        }
+
+        if(error != NULL)
+            c.printf("e %s\n", error);
+        else {
+            c.printf("c conflicts %" PRIu64 " time %g\n", S->conflicts, wallTime() - initial_time);
+            c.printf(result == l_True ? "s SATISFIABLE\n" : result == l_False ? "s UNSATISFIABLE\n" : "s UNKNOWN\n");
+            if(result == l_True && send_model) {
+                c.printf("v");
+                for(int i = 0; i < S->nVars(); i++) {
+                    if(i % 16 == 15) c.printf("\nv");
+                    if(S->model[i] != l_Undef) c.printf(" %s%d", S->model[i] == l_True ? "" : "-", i + 1);
+                }
+                c.printf(" 0\n");
+            }
+        }
+        bool sent = c.flush();
+
+        delete S;
+        spare = newSolver();
+        if(!sent) return;
+    }
+}
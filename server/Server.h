@@ -0,0 +1,66 @@
+#ifndef Minisat_Server_h
+#define Minisat_Server_h
+
+#include <pthread.h>
+#include <signal.h>
+
+#include "mtl/Vec.h"
+#include "mtl/Alg.h"
+#include "core/Solver.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// SolverServer -- answers solve requests on a Unix domain socket:
+//
+// A request is a header line followed by the formula, of the given size in bytes:
+//
+//   solve <cnf|bcnf> <bytes> [conflicts=<n>] [seed=<n>] [model=<0|1>]
+//
+// and the reply is, in the format of the SAT competition:
+//
+//   c conflicts <n> time <seconds>
+//   s SATISFIABLE | s UNSATISFIABLE | s UNKNOWN (budget exhausted)
+//   v <lits> ... 0                          (if satisfiable, unless model=0)
+//
+// or 'e <message>' if the request is invalid. A connection may send any number of requests, and is
+// closed by the server after an invalid header. 'bcnf' is the binary CNF, in 32-bit little-endian
+// words: 'BCNF' <nb vars> <nb clauses>, then the DIMACS literals of each clause, ended by 0.
+//
+// Connections are served by a fixed set of threads, each holding a solver built in advance for
+// its next request. A search is stopped when its client hangs up.
+
+    class SolverServer {
+        char *path;
+        int listen_fd;
+        int wake_fds[2];                // A pipe written by 'stop()' to wake 'loop()' (the signal may reach any thread).
+        pthread_mutex_t lock;
+        pthread_cond_t pending;
+        vec<int> connections;           // The accepted connections, not yet served.
+        int head;                       // The first connection of the queue.
+        vec<int> active;                // The connections being served.
+        vec<pthread_t> threads;
+        volatile sig_atomic_t stopping;
+
+        static void *worker(void *server);
+        void run();
+        void serve(int fd, Solver *&spare);
+        Solver *newSolver();
+
+    public:
+        SolverServer(const char *path, int nb_threads);
+        ~SolverServer();                // Closes the connections in progress, and removes the socket.
+
+        int64_t default_conflicts;      // The budget of a request that does not give one (-1 means none).
+        int max_input;                  // The largest formula accepted, in bytes.
+        int64_t nb_requests;            // Statistics (read when the server is stopped).
+
+        bool listen();                  // Bind the socket (FALSE on error, see 'errno').
+        void loop();                    // Accept connections until 'stop()'.
+        void stop();                    // Make 'loop()' return (may be called from a signal handler).
+    };
+
+//=================================================================================================
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef Minisat_Histogram_h
+#define Minisat_Histogram_h
+
+#include <stdio.h>
+
+#include "mtl/IntTypes.h"
+
+namespace CDCL {
+
+//=================================================================================================
+// Histogram -- counts of non-negative values, in buckets of powers of 2:
+//
+// Bucket 0 holds the value 0, and bucket 'b' > 0 the values in [2^(b-1), 2^b[.
+
+class Histogram {
+    enum { nb_buckets = 33 };
+    uint64_t counts[nb_buckets];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max_value;
+
+public:
+    Histogram() { clear(); }
+
+    void clear() {
+        for (int b = 0; b < nb_buckets; b++) counts[b] = 0;
+        total = sum = max_value = 0; }
+
+    void add(uint32_t x) {
+        int b = 0;
+        for (uint32_t y = x; y != 0; y >>= 1) b++;
+        counts[b]++;
+        total++;
+        sum += x;
+        if (x > max_value) max_value = x; }
+
+    uint64_t size () const { return total; }
+    double   mean () const { return total == 0 ? 0 : (double)sum / total; }
+    uint64_t max  () const { return max_value; }
+
+    // One comment line for the summary, then one per non-empty bucket with its share of the values:
+    void print(FILE* out, const char* name) const {
+        fprintf(out, "c %-22s: %-12" PRIu64 "   (mean %.2f, max %" PRIu64 ")\n", name, total, mean(), max_value);
+        for (int b = 0; b < nb_buckets; b++){
+            if (counts[b] == 0) continue;
+            uint64_t lo = b == 0 ? 0 : (uint64_t)1 << (b - 1);
+            uint64_t hi = b == 0 ? 0 : ((uint64_t)1 << b) - 1;
+            fprintf(out, "c   %10" PRIu64 "..%-10" PRIu64 ": %6.2f %%\n", lo, hi, counts[b] * 100.0 / total); } }
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -6,6 +6,8 @@
 
 #include <zlib.h>
 
+#include "mtl/IntTypes.h"
+
 namespace CDCL {
 
 //-------------------------------------------------------------------------------------------------
@@ -73,6 +75,17 @@ static int parseInt(B& in) {
     return neg ? -val : val; }
 
 
+// A 64-bit number in lower-case hexadecimal (as printed with PRIx64):
+template<class B>
+static uint64_t parseHex(B& in) {
+    uint64_t val = 0;
+    skipWhitespace(in);
+    for (;; ++in)
+        if      (*in >= '0' && *in <= '9') val = val << 4 | (uint64_t)(*in - '0');
+        else if (*in >= 'a' && *in <= 'f') val = val << 4 | (uint64_t)(*in - 'a' + 10);
+        else return val; }
+
+
 // String matching: in case of a match the input iterator will be advanced the corresponding
 // number of characters.
 template<class B>